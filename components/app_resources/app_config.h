@@ -0,0 +1,44 @@
+/*
+ * Application Resource Configuration
+ *
+ * Stack sizes, priorities and queue lengths of every application task and
+ * queue. All of them are allocated statically from these values, so the
+ * RAM budget is fixed at link time. Optional board sensors are enabled
+ * here too.
+ */
+
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+// Stack sizes are in bytes
+
+// Zigbee stack main loop
+#define APP_ZIGBEE_TASK_STACK_SIZE 4096
+#define APP_ZIGBEE_TASK_PRIORITY 5
+
+// Sensor manager scheduler
+#define APP_SENSOR_TASK_STACK_SIZE 4096
+#define APP_SENSOR_TASK_PRIORITY 5
+#define APP_SENSOR_EVENT_QUEUE_LEN 16        // At least SENSOR_MAX_INSTANCES
+
+// Sensor update subscribers, one dispatch task each
+#define APP_SENSOR_SUBSCRIBERS 2
+#define APP_SENSOR_SUBSCRIBER_TASK_STACK_SIZE 4096
+#define APP_SENSOR_SUBSCRIBER_TASK_PRIORITY 4
+
+// DHT22 driver
+#define APP_DHT22_TASK_STACK_SIZE 3072
+#define APP_DHT22_TASK_PRIORITY 6
+#define APP_DHT22_EVENT_QUEUE_LEN 8          // At least 2 * DHT22_MAX_SENSORS
+
+// Entries in the boot-time resource report
+#define APP_RESOURCES_MAX 16
+
+// HC-SR04 door sensor. Off by default: the driver cannot tell whether a sensor
+// is wired, and once enabled its trigger pin is pulsed at the sampling rate.
+// The 5 V echo needs a divider.
+#define APP_HCSR04_ENABLED 0
+#define APP_HCSR04_TRIGGER_GPIO 2
+#define APP_HCSR04_ECHO_GPIO 3
+
+#endif // APP_CONFIG_H
@@ -0,0 +1,122 @@
+/*
+ * Application Resource Registry Implementation
+ */
+
+#include "app_resources.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+static const char *TAG = "APP_RESOURCES";
+
+typedef enum {
+    APP_RESOURCE_TASK,
+    APP_RESOURCE_QUEUE,
+    APP_RESOURCE_STATIC,
+} app_resource_kind_t;
+
+typedef struct {
+    app_resource_kind_t kind;
+    const char *name;
+    uint32_t size;               // Bytes reserved
+    union {
+        TaskHandle_t task;
+        QueueHandle_t queue;
+    };
+    uint32_t length;             // Queue length
+} app_resource_t;
+
+static app_resource_t resources[APP_RESOURCES_MAX];
+static uint8_t resource_count = 0;
+static portMUX_TYPE resource_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool app_resources_add(const app_resource_t *resource)
+{
+    bool added = false;
+
+    portENTER_CRITICAL(&resource_lock);
+    if (resource_count < APP_RESOURCES_MAX) {
+        resources[resource_count++] = *resource;
+        added = true;
+    }
+    portEXIT_CRITICAL(&resource_lock);
+
+    if (!added) {
+        ESP_LOGW(TAG, "Resource table full, %s not tracked", resource->name);
+    }
+    return added;
+}
+
+bool app_resources_register_task(TaskHandle_t task, uint32_t stack_size)
+{
+    if (task == NULL) {
+        return false;
+    }
+
+    app_resource_t resource = {
+        .kind = APP_RESOURCE_TASK,
+        .name = pcTaskGetName(task),
+        .size = stack_size,
+        .task = task,
+    };
+    return app_resources_add(&resource);
+}
+
+bool app_resources_register_queue(const char *name, QueueHandle_t queue, uint32_t length, uint32_t item_size)
+{
+    if (queue == NULL) {
+        return false;
+    }
+
+    app_resource_t resource = {
+        .kind = APP_RESOURCE_QUEUE,
+        .name = name,
+        .size = length * item_size,
+        .queue = queue,
+        .length = length,
+    };
+    return app_resources_add(&resource);
+}
+
+bool app_resources_register_static(const char *name, uint32_t size)
+{
+    app_resource_t resource = {
+        .kind = APP_RESOURCE_STATIC,
+        .name = name,
+        .size = size,
+    };
+    return app_resources_add(&resource);
+}
+
+void app_resources_report(void)
+{
+    uint32_t total = 0;
+
+    ESP_LOGI(TAG, "Static allocations:");
+    portENTER_CRITICAL(&resource_lock);
+    uint8_t count = resource_count;
+    portEXIT_CRITICAL(&resource_lock);
+
+    for (uint8_t i = 0; i < count; i++) {
+        const app_resource_t *resource = &resources[i];
+        total += resource->size;
+        switch (resource->kind) {
+            case APP_RESOURCE_TASK: {
+                // High-water mark is the least free stack seen, in bytes on ESP-IDF
+                uint32_t free_min = uxTaskGetStackHighWaterMark(resource->task);
+                ESP_LOGI(TAG, "  task  %-16s stack %5lu B, peak use %5lu B, min free %5lu B",
+                         resource->name, resource->size, resource->size - free_min, free_min);
+                break;
+            }
+            case APP_RESOURCE_QUEUE:
+                ESP_LOGI(TAG, "  queue %-16s %5lu B, %lu/%lu queued", resource->name, resource->size,
+                         (uint32_t)uxQueueMessagesWaiting(resource->queue), resource->length);
+                break;
+            case APP_RESOURCE_STATIC:
+                ESP_LOGI(TAG, "  data  %-16s %5lu B", resource->name, resource->size);
+                break;
+        }
+    }
+
+    ESP_LOGI(TAG, "Total %lu B static; heap free %lu B, minimum ever %lu B", total,
+             esp_get_free_heap_size(), esp_get_minimum_free_heap_size());
+}
@@ -0,0 +1,24 @@
+/*
+ * Application Resource Registry
+ *
+ * Components register their statically allocated tasks and queues here so
+ * the whole memory budget can be reported in one place.
+ */
+
+#ifndef APP_RESOURCES_H
+#define APP_RESOURCES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "app_config.h"
+
+bool app_resources_register_task(TaskHandle_t task, uint32_t stack_size);
+bool app_resources_register_queue(const char *name, QueueHandle_t queue, uint32_t length, uint32_t item_size);
+bool app_resources_register_static(const char *name, uint32_t size);
+// Log every registered allocation with its usage, plus heap statistics
+void app_resources_report(void);
+
+#endif // APP_RESOURCES_H
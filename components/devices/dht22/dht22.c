@@ -1,176 +1,936 @@
 /*
  * DHT22 Temperature and Humidity Sensor Driver Implementation
  *
- * Implements the DHT22 single-wire communication protocol
+ * Implements the DHT22 single-wire communication protocol.
+ * The frame is captured by an RMT RX channel, which timestamps every edge
+ * in hardware; the CPU only wakes up once the whole frame has been received.
  */
 
 #include "dht22.h"
+#include "dht22_decode.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "driver/gpio.h"
+#include "driver/rmt_rx.h"
+#include "soc/soc_caps.h"
 #include "esp_timer.h"
 #include "esp_log.h"
+#include "timing.h"
+#include "app_resources.h"
 
 static const char *TAG = "DHT22";
 
-#define DHT22_TIMEOUT_US 1000000  // 1 second timeout
-#define DHT22_DATA_BITS 40        // 5 bytes * 8 bits
-
-// Timing constants for DHT22 protocol (microseconds)
+// Host start signal (microseconds)
 #define DHT22_START_SIGNAL_LOW_US 1100
-#define DHT22_START_SIGNAL_HIGH_US 30
-#define DHT22_RESPONSE_LOW_US 80
-#define DHT22_RESPONSE_HIGH_US 80
-#define DHT22_BIT_0_HIGH_US 26
-#define DHT22_BIT_1_HIGH_US 70
 
-static int dht22_gpio_pin = -1;
-static bool dht22_initialized = false;
+// RMT capture configuration
+#define DHT22_RMT_RESOLUTION_HZ (1 * 1000 * 1000)  // 1 tick = 1 us
+#define DHT22_RMT_MEM_SYMBOLS SOC_RMT_MEM_WORDS_PER_CHANNEL
+#define DHT22_RMT_GLITCH_NS 1000              // Ignore pulses shorter than 1 us
+#define DHT22_RMT_IDLE_NS (200 * 1000)        // Line idle for 200 us ends the frame
+#define DHT22_TRANSACTION_TIMEOUT_MS 50
+#define DHT22_MIN_INTERVAL_MS 2000            // Sensor needs 2 s between transactions
+#define DHT22_MAX_EDGES (2 * DHT22_RMT_MEM_SYMBOLS + 1)
+
+_Static_assert(APP_DHT22_EVENT_QUEUE_LEN >= 2 * DHT22_MAX_SENSORS, "DHT22 event queue too short");
+
+// Events processed by the driver task
+typedef enum {
+    DHT22_EVENT_START,        // Begin a transaction (from dht22_read_async)
+    DHT22_EVENT_RX_DONE,      // RMT finished capturing a frame (from ISR)
+    DHT22_EVENT_ARM_FAILED,   // Capture could not be armed (from start timer)
+} dht22_event_type_t;
+
+typedef struct {
+    dht22_event_type_t type;
+    dht22_handle_t dev;
+    uint32_t seq;             // Transaction the event belongs to
+    timing_cycles_t cycles;   // Cycle timestamp at which the event was raised
+    size_t num_symbols;
+    esp_err_t status;
+} dht22_event_t;
+
+// Per-sensor state. RMT RX channels are scarce (two on the ESP32-C6), so a
+// channel is only held while a transaction is on the wire; sensors that find
+// no free channel wait in the pending state until another transaction ends.
+struct dht22_dev_t {
+    bool in_use;
+    int gpio_pin;
+    esp_timer_handle_t start_timer;
+    rmt_channel_handle_t rx_channel;
+    rmt_symbol_word_t rx_symbols[DHT22_RMT_MEM_SYMBOLS];
+
+    // Request state, guarded by dht22_lock
+    bool busy;
+    dht22_read_cb_t callback;
+    void *callback_ctx;
+
+    // Cached health and diagnostics, guarded by dht22_lock
+    dht22_health_t health;
+    dht22_diag_t last_diag;
+    dht22_diag_t last_failure_diag;
+    dht22_counters_t counters;
+
+    // Request options, written by dht22_read_async before the start event
+    uint8_t attempts_left;
+    bool has_deadline;
+    TickType_t request_deadline;
+
+    // Transaction state, owned by the driver task
+    bool pending;             // Waiting for the spacing to elapse or a free RMT channel
+    bool active;              // A transaction is on the wire
+    volatile uint32_t seq;
+    TickType_t rx_deadline;   // Timeout of the transaction on the wire
+    TickType_t not_before;    // Earliest start honouring DHT22_MIN_INTERVAL_MS
+    timing_cycles_t start_cycles;           // Start signal asserted
+    volatile timing_cycles_t armed_cycles;  // Line released and capture armed
+    uint8_t attempt;                        // Attempts made for the current request
+    dht22_diag_t diag;                      // Diagnostics of the transaction in progress
+    dht22_error_t request_error;  // Failure of the request's latest attempt
+};
+
+// Blocking read support: one slot per sensor in a dht22_read_many() call
+typedef struct {
+    SemaphoreHandle_t done;
+    portMUX_TYPE lock;
+    size_t remaining;
+} dht22_waiter_t;
+
+typedef struct {
+    dht22_waiter_t *waiter;
+    dht22_reading_t *reading;
+} dht22_waiter_slot_t;
+
+static struct dht22_dev_t dht22_devices[DHT22_MAX_SENSORS];
+static portMUX_TYPE dht22_lock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t dht22_event_queue = NULL;
+static TaskHandle_t dht22_task_handle = NULL;
+static StaticQueue_t dht22_event_queue_buffer;
+static uint8_t dht22_event_queue_storage[APP_DHT22_EVENT_QUEUE_LEN * sizeof(dht22_event_t)];
+static StaticTask_t dht22_task_buffer;
+static StackType_t dht22_task_stack[APP_DHT22_TASK_STACK_SIZE];
+
+static const rmt_receive_config_t dht22_receive_config = {
+    .signal_range_min_ns = DHT22_RMT_GLITCH_NS,
+    .signal_range_max_ns = DHT22_RMT_IDLE_NS,
+};
+
+static bool dht22_rx_done_cb(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_ctx)
+{
+    dht22_handle_t dev = (dht22_handle_t)user_ctx;
+    BaseType_t task_woken = pdFALSE;
+    dht22_event_t event = {
+        .type = DHT22_EVENT_RX_DONE,
+        .dev = dev,
+        .seq = dev->seq,
+        .cycles = timing_cycles_now(),
+        .num_symbols = edata->num_symbols,
+        .status = ESP_OK,
+    };
+    xQueueSendFromISR(dht22_event_queue, &event, &task_woken);
+    return task_woken == pdTRUE;
+}
+
+// Fires at the end of the host start signal: arm the capture, then release the line
+static void dht22_start_timer_cb(void *arg)
+{
+    dht22_handle_t dev = (dht22_handle_t)arg;
+    dev->armed_cycles = timing_cycles_now();
+    esp_err_t ret = rmt_receive(dev->rx_channel, dev->rx_symbols, sizeof(dev->rx_symbols),
+                                &dht22_receive_config);
+    gpio_set_level(dev->gpio_pin, 1);
 
-static inline void delay_us(uint32_t us) {
-    uint64_t start = esp_timer_get_time();
-    while ((esp_timer_get_time() - start) < us) {
-        // Busy wait
+    if (ret != ESP_OK) {
+        dht22_event_t event = {
+            .type = DHT22_EVENT_ARM_FAILED,
+            .dev = dev,
+            .seq = dev->seq,
+            .cycles = timing_cycles_now(),
+            .num_symbols = 0,
+            .status = ret,
+        };
+        xQueueSend(dht22_event_queue, &event, 0);
     }
 }
 
-static bool dht22_wait_for_level(gpio_num_t pin, int level, uint32_t timeout_us) {
-    uint64_t start = esp_timer_get_time();
-    while (gpio_get_level(pin) != level) {
-        if ((esp_timer_get_time() - start) > timeout_us) {
-            return false;
+static esp_err_t dht22_configure_gpio(int gpio_pin)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << gpio_pin),
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,  // Open drain for DHT22 protocol
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret == ESP_OK) {
+        // Set pin high (idle state)
+        gpio_set_level(gpio_pin, 1);
+    }
+    return ret;
+}
+
+static esp_err_t dht22_acquire_channel(dht22_handle_t dev)
+{
+    rmt_rx_channel_config_t rx_conf = {
+        .gpio_num = dev->gpio_pin,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = DHT22_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = DHT22_RMT_MEM_SYMBOLS,
+    };
+
+    esp_err_t ret = rmt_new_rx_channel(&rx_conf, &dev->rx_channel);
+    if (ret != ESP_OK) {
+        dev->rx_channel = NULL;
+        return ret;
+    }
+
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = dht22_rx_done_cb,
+    };
+    ret = rmt_rx_register_event_callbacks(dev->rx_channel, &cbs, dev);
+    if (ret == ESP_OK) {
+        ret = rmt_enable(dev->rx_channel);
+    }
+    if (ret == ESP_OK) {
+        // Reapply the pad setup after the RMT so the open-drain output stays enabled
+        ret = dht22_configure_gpio(dev->gpio_pin);
+    }
+    if (ret != ESP_OK) {
+        rmt_disable(dev->rx_channel);
+        rmt_del_channel(dev->rx_channel);
+        dev->rx_channel = NULL;
+    }
+    return ret;
+}
+
+static void dht22_release_channel(dht22_handle_t dev)
+{
+    if (dev->rx_channel == NULL) {
+        return;
+    }
+    // Disabling also aborts a receive that is still pending
+    rmt_disable(dev->rx_channel);
+    rmt_del_channel(dev->rx_channel);
+    dev->rx_channel = NULL;
+    dht22_configure_gpio(dev->gpio_pin);
+}
+
+// Convert the captured RMT symbols into edge timestamps for the decoder
+static size_t dht22_symbols_to_edges(const rmt_symbol_word_t *symbols, size_t num_symbols,
+                                     uint32_t *edges_us, size_t max_edges, int *first_level)
+{
+    size_t count = 0;
+    uint32_t now = 0;
+
+    if (num_symbols == 0 || max_edges == 0) {
+        return 0;
+    }
+    *first_level = symbols[0].level0;
+    edges_us[count++] = now;
+
+    for (size_t i = 0; i < num_symbols && count < max_edges; i++) {
+        if (symbols[i].duration0 == 0) {
+            break;
+        }
+        now += symbols[i].duration0;
+        edges_us[count++] = now;
+        if (symbols[i].duration1 == 0 || count >= max_edges) {
+            break;
+        }
+        now += symbols[i].duration1;
+        edges_us[count++] = now;
+    }
+    return count;
+}
+
+static dht22_error_t dht22_error_from_decode(dht22_decode_status_t status)
+{
+    switch (status) {
+        case DHT22_DECODE_OK:
+            return DHT22_ERROR_NONE;
+        case DHT22_DECODE_ERR_RESPONSE_LOW:
+            return DHT22_ERROR_RESPONSE_LOW;
+        case DHT22_DECODE_ERR_RESPONSE_HIGH:
+            return DHT22_ERROR_RESPONSE_HIGH;
+        case DHT22_DECODE_ERR_BIT_LOW:
+            return DHT22_ERROR_BIT_LOW;
+        case DHT22_DECODE_ERR_BIT_HIGH:
+            return DHT22_ERROR_BIT_HIGH;
+        case DHT22_DECODE_ERR_CHECKSUM:
+            return DHT22_ERROR_CHECKSUM;
+        case DHT22_DECODE_ERR_RANGE:
+            return DHT22_ERROR_RANGE;
+        case DHT22_DECODE_ERR_ARG:
+        case DHT22_DECODE_ERR_INCOMPLETE:
+        default:
+            return DHT22_ERROR_INCOMPLETE;
+    }
+}
+
+static bool dht22_decode_frame(dht22_handle_t dev, size_t num_symbols, dht22_reading_t *reading)
+{
+    uint32_t edges_us[DHT22_MAX_EDGES];
+    int first_level = 1;
+    size_t num_edges = dht22_symbols_to_edges(dev->rx_symbols, num_symbols,
+                                              edges_us, DHT22_MAX_EDGES, &first_level);
+
+    dht22_frame_t frame;
+    dht22_decode_status_t status = dht22_decode_edges(edges_us, num_edges, first_level, &frame);
+    reading->error = dht22_error_from_decode(status);
+
+    dht22_diag_t *diag = &dev->diag;
+    diag->num_edges = (uint16_t)num_edges;
+    diag->error_bit = frame.error_bit;
+    diag->error_pulse_us = frame.error_pulse_us;
+    diag->response_low_us = frame.response_low_us;
+    diag->response_high_us = frame.response_high_us;
+    diag->data_us = frame.data_us;
+    diag->bit_threshold_us = frame.bit_threshold_us;
+    diag->bit_margin_us = frame.bit_margin_us;
+    for (int i = 0; i < DHT22_DATA_BYTES; i++) {
+        diag->raw[i] = frame.data[i];
+    }
+    if (status != DHT22_DECODE_OK) {
+        if (status == DHT22_DECODE_ERR_BIT_LOW || status == DHT22_DECODE_ERR_BIT_HIGH) {
+            ESP_LOGW(TAG, "GPIO %d: decode failed: %s at bit %d of byte %d (%u us)", dev->gpio_pin,
+                     dht22_decode_status_to_name(status), frame.error_bit % 8, frame.error_bit / 8,
+                     frame.error_pulse_us);
+        } else if (status == DHT22_DECODE_ERR_CHECKSUM) {
+            uint8_t checksum = frame.data[0] + frame.data[1] + frame.data[2] + frame.data[3];
+            ESP_LOGW(TAG, "GPIO %d: checksum failed: calculated %d, received %d", dev->gpio_pin,
+                     checksum, frame.data[4]);
+        } else if (status == DHT22_DECODE_ERR_RANGE) {
+            ESP_LOGW(TAG, "GPIO %d: value out of range: %.1f°C, %.1f%%", dev->gpio_pin,
+                     frame.temperature_deci_c / 10.0f, frame.humidity_deci_pct / 10.0f);
+        } else {
+            ESP_LOGW(TAG, "GPIO %d: decode failed: %s (%u edges)", dev->gpio_pin,
+                     dht22_decode_status_to_name(status), (unsigned)num_edges);
         }
+        return false;
+    }
+
+    // Track how close the bit decisions were to failing
+    portENTER_CRITICAL(&dht22_lock);
+    dht22_health_t *health = &dev->health;
+    health->last_bit_threshold_us = frame.bit_threshold_us;
+    health->last_bit_margin_us = frame.bit_margin_us;
+    if (frame.bit_margin_us < health->min_bit_margin_us) {
+        health->min_bit_margin_us = frame.bit_margin_us;
+    }
+    if (frame.bit_margin_us < DHT22_LOW_MARGIN_US) {
+        health->low_margin_frames++;
+    }
+    portEXIT_CRITICAL(&dht22_lock);
+
+    if (frame.bit_margin_us < DHT22_LOW_MARGIN_US) {
+        ESP_LOGW(TAG, "GPIO %d: marginal link, bit margin %u us (threshold %u us, 0=%u us, 1=%u us)",
+                 dev->gpio_pin, frame.bit_margin_us, frame.bit_threshold_us,
+                 frame.zero_high_us, frame.one_high_us);
+    }
+
+    // The sensor reports tenths and the decoder checked the range, so
+    // scaling to hundredths is exact and fits
+    reading->humidity_centi_pct = frame.humidity_deci_pct * 10;
+    reading->temperature_centi_c = frame.temperature_deci_c * 10;
+    reading->valid = true;
+
+    ESP_LOGD(TAG, "GPIO %d: Temperature=%.1f°C, Humidity=%.1f%%",
+             dev->gpio_pin, reading->temperature_centi_c / 100.0f, reading->humidity_centi_pct / 100.0f);
+    return true;
+}
+
+static inline bool dht22_tick_reached(TickType_t now, TickType_t target)
+{
+    return (int32_t)(now - target) >= 0;
+}
+
+// Record the outcome of one transaction in the cached health and diagnostics
+static void dht22_record_attempt(dht22_handle_t dev, const dht22_reading_t *reading)
+{
+    int64_t now = esp_timer_get_time();
+    dht22_diag_t *diag = &dev->diag;
+    diag->timestamp_us = now;
+    diag->error = reading->valid ? DHT22_ERROR_NONE : reading->error;
+
+    portENTER_CRITICAL(&dht22_lock);
+    dht22_counters_t *counters = &dev->counters;
+    counters->transactions++;
+    if (diag->attempt > 1) {
+        counters->retries++;
+    }
+    if (reading->valid) {
+        counters->successes++;
+    } else {
+        counters->errors[diag->error]++;
+        dev->last_failure_diag = *diag;
+    }
+    if (diag->start_signal_us > counters->max_start_signal_us) {
+        counters->max_start_signal_us = diag->start_signal_us;
+    }
+    if (diag->capture_us > counters->max_capture_us) {
+        counters->max_capture_us = diag->capture_us;
+    }
+    dev->last_diag = *diag;
+
+    dht22_health_t *health = &dev->health;
+    health->last_attempt_us = now;
+    if (reading->valid) {
+        health->last_success_us = now;
+        health->consecutive_failures = 0;
+        health->state = DHT22_HEALTH_OK;
+    } else {
+        health->consecutive_failures++;
+        health->last_error = reading->error;
+        health->state = health->consecutive_failures >= DHT22_HEALTH_FAILURE_THRESHOLD ?
+                        DHT22_HEALTH_FAILED : DHT22_HEALTH_DEGRADED;
+    }
+    portEXIT_CRITICAL(&dht22_lock);
+}
+
+// Finish the request and hand the result to the requester
+static void dht22_complete(dht22_handle_t dev, const dht22_reading_t *reading)
+{
+    dev->active = false;
+    dev->pending = false;
+
+    portENTER_CRITICAL(&dht22_lock);
+    dev->counters.requests++;
+    if (!reading->valid) {
+        dev->counters.request_failures++;
+        if (reading->error == DHT22_ERROR_DEADLINE) {
+            dev->counters.errors[DHT22_ERROR_DEADLINE]++;
+        }
+    }
+    dht22_read_cb_t callback = dev->callback;
+    void *ctx = dev->callback_ctx;
+    dev->callback = NULL;
+    dev->busy = false;
+    portEXIT_CRITICAL(&dht22_lock);
+
+    if (callback) {
+        callback(dev, reading, ctx);
+    }
+}
+
+static void dht22_fail(dht22_handle_t dev, dht22_error_t error)
+{
+    dht22_reading_t failed = {
+        .valid = false,
+        .error = error,
+    };
+    dht22_complete(dev, &failed);
+}
+
+// Whether a transaction started at 'start' could still finish before the request deadline
+static bool dht22_fits_deadline(dht22_handle_t dev, TickType_t start)
+{
+    if (!dev->has_deadline) {
+        return true;
+    }
+    TickType_t finish = start + pdMS_TO_TICKS(DHT22_TRANSACTION_TIMEOUT_MS);
+    return !dht22_tick_reached(finish, dev->request_deadline + 1);
+}
+
+// A transaction finished; retry within the request's budget or complete it
+static void dht22_attempt_done(dht22_handle_t dev, const dht22_reading_t *reading)
+{
+    dev->active = false;
+    dht22_record_attempt(dev, reading);
+    dev->request_error = reading->error;
+
+    if (!reading->valid && dev->attempts_left > 0 && dht22_fits_deadline(dev, dev->not_before)) {
+        ESP_LOGD(TAG, "GPIO %d: retrying after %s (%u attempts left)", dev->gpio_pin,
+                 dht22_error_to_name(reading->error), dev->attempts_left);
+        dev->pending = true;
+        return;
+    }
+    dht22_complete(dev, reading);
+}
+
+static void dht22_attempt_failed(dht22_handle_t dev, dht22_error_t error)
+{
+    dht22_reading_t failed = {
+        .valid = false,
+        .error = error,
+    };
+    dht22_attempt_done(dev, &failed);
+}
+
+// Put the transaction on the wire; returns false if no RMT channel is free yet
+static bool dht22_start_transaction(dht22_handle_t dev)
+{
+    esp_err_t ret = dht22_acquire_channel(dev);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        return false;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    dev->pending = false;
+    dev->attempts_left--;
+    dev->attempt++;
+    dev->diag = (dht22_diag_t) {
+        .seq = dev->seq + 1,
+        .attempt = dev->attempt,
+        .error_bit = -1,
+    };
+    // The sensor needs DHT22_MIN_INTERVAL_MS between the starts of two transactions
+    dev->not_before = now + pdMS_TO_TICKS(DHT22_MIN_INTERVAL_MS);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "GPIO %d: failed to acquire RMT channel: %s", dev->gpio_pin, esp_err_to_name(ret));
+        dht22_attempt_failed(dev, DHT22_ERROR_START);
+        return true;
+    }
+
+    dev->seq++;
+    dev->active = true;
+    dev->rx_deadline = now + pdMS_TO_TICKS(DHT22_TRANSACTION_TIMEOUT_MS);
+
+    // Send start signal; the timer releases the line and arms the capture
+    gpio_set_level(dev->gpio_pin, 0);
+    dev->start_cycles = timing_cycles_now();
+    if (esp_timer_start_once(dev->start_timer, DHT22_START_SIGNAL_LOW_US) != ESP_OK) {
+        ESP_LOGW(TAG, "GPIO %d: failed to start transaction", dev->gpio_pin);
+        dht22_release_channel(dev);
+        dht22_attempt_failed(dev, DHT22_ERROR_START);
     }
     return true;
 }
 
-static int dht22_read_bit(gpio_num_t pin) {
-    // Wait for the pin to go low (start of bit)
-    if (!dht22_wait_for_level(pin, 0, 100)) {
-        return -1;
+static void dht22_abort_transaction(dht22_handle_t dev)
+{
+    esp_timer_stop(dev->start_timer);
+    dht22_release_channel(dev);
+    dev->seq++;
+}
+
+// Expire transactions and requests, then start every pending request whose
+// spacing has elapsed while RMT channels are available
+static void dht22_service(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    bool channels_exhausted = false;
+
+    for (int i = 0; i < DHT22_MAX_SENSORS; i++) {
+        dht22_handle_t dev = &dht22_devices[i];
+        if (dev->active && dht22_tick_reached(now, dev->rx_deadline)) {
+            dht22_abort_transaction(dev);
+            ESP_LOGW(TAG, "GPIO %d: timeout waiting for frame", dev->gpio_pin);
+            dht22_attempt_failed(dev, DHT22_ERROR_TIMEOUT);
+        }
+    }
+
+    for (int i = 0; i < DHT22_MAX_SENSORS; i++) {
+        dht22_handle_t dev = &dht22_devices[i];
+        if (!dev->pending) {
+            continue;
+        }
+        TickType_t start = dht22_tick_reached(now, dev->not_before) ? now : dev->not_before;
+        if (!dht22_fits_deadline(dev, start)) {
+            // Report the failure of the last attempt if there was one
+            ESP_LOGW(TAG, "GPIO %d: read deadline expired", dev->gpio_pin);
+            dht22_fail(dev, dev->request_error);
+            continue;
+        }
+        if (start != now) {
+            continue;
+        }
+        if (channels_exhausted || !dht22_start_transaction(dev)) {
+            // No RMT channel left; retry when the next transaction finishes
+            // unless the request has run out of time waiting for one
+            channels_exhausted = true;
+            dev->request_error = DHT22_ERROR_TIMEOUT;
+            if (dev->has_deadline && dht22_tick_reached(now, dev->request_deadline)) {
+                ESP_LOGW(TAG, "GPIO %d: no RMT channel before the read deadline", dev->gpio_pin);
+                dht22_fail(dev, DHT22_ERROR_TIMEOUT);
+            }
+        }
+    }
+}
+
+// Time until the earliest transaction timeout, spacing expiry or request deadline
+static TickType_t dht22_next_wait(void)
+{
+    TickType_t wait = portMAX_DELAY;
+    TickType_t now = xTaskGetTickCount();
+    for (int i = 0; i < DHT22_MAX_SENSORS; i++) {
+        dht22_handle_t dev = &dht22_devices[i];
+        TickType_t targets[2];
+        int num_targets = 0;
+        if (dev->active) {
+            targets[num_targets++] = dev->rx_deadline;
+        } else if (dev->pending) {
+            // Once the spacing has elapsed, only a channel release (an event) can start it
+            if (!dht22_tick_reached(now, dev->not_before)) {
+                targets[num_targets++] = dev->not_before;
+            }
+            if (dev->has_deadline) {
+                targets[num_targets++] = dev->request_deadline;
+            }
+        }
+        for (int t = 0; t < num_targets; t++) {
+            int32_t remaining = (int32_t)(targets[t] - now);
+            TickType_t dev_wait = remaining > 0 ? (TickType_t)remaining : 0;
+            if (dev_wait < wait) {
+                wait = dev_wait;
+            }
+        }
     }
+    return wait;
+}
+
+static void dht22_task(void *pvParameters)
+{
+    while (true) {
+        dht22_event_t event;
+        bool received = xQueueReceive(dht22_event_queue, &event, dht22_next_wait()) == pdTRUE;
+
+        if (received) {
+            dht22_handle_t dev = event.dev;
+            if (event.type == DHT22_EVENT_START) {
+                dev->pending = true;
+                dev->request_error = DHT22_ERROR_DEADLINE;
+                dev->attempt = 0;
+            } else if (dev->active && event.seq == dev->seq) {
+                // Events from a transaction that already timed out fail the seq check
+                dht22_reading_t reading = {
+                    .valid = false,
+                    .error = DHT22_ERROR_START,
+                };
+                dht22_release_channel(dev);
+                if (event.type == DHT22_EVENT_ARM_FAILED) {
+                    ESP_LOGW(TAG, "GPIO %d: failed to arm capture: %s", dev->gpio_pin,
+                             esp_err_to_name(event.status));
+                } else {
+                    dev->diag.start_signal_us = timing_cycles_to_us(dev->armed_cycles - dev->start_cycles);
+                    dev->diag.capture_us = timing_cycles_to_us(event.cycles - dev->armed_cycles);
+                    ESP_LOGD(TAG, "GPIO %d: start signal %lu us, capture %lu us", dev->gpio_pin,
+                             (unsigned long)dev->diag.start_signal_us, (unsigned long)dev->diag.capture_us);
+                    dht22_decode_frame(dev, event.num_symbols, &reading);
+                }
+                dht22_attempt_done(dev, &reading);
+            }
+        }
 
-    // Measure how long it stays low
-    uint64_t start = esp_timer_get_time();
-    if (!dht22_wait_for_level(pin, 1, 100)) {
-        return -1;
+        dht22_service();
     }
-    uint32_t low_time = esp_timer_get_time() - start;
+}
 
-    // Wait for the pin to go low again (end of bit)
-    if (!dht22_wait_for_level(pin, 0, 100)) {
-        return -1;
+static bool dht22_driver_start(void)
+{
+    if (dht22_task_handle != NULL) {
+        return true;
     }
 
-    // DHT22 protocol: bit 0 has ~26us high time, bit 1 has ~70us high time
-    return (low_time > 40) ? 1 : 0;
+    dht22_event_queue = xQueueCreateStatic(APP_DHT22_EVENT_QUEUE_LEN, sizeof(dht22_event_t),
+                                           dht22_event_queue_storage, &dht22_event_queue_buffer);
+
+    // Driver task sequences transactions, decodes frames and runs completion callbacks
+    dht22_task_handle = xTaskCreateStatic(dht22_task,
+                                          "dht22",
+                                          APP_DHT22_TASK_STACK_SIZE,
+                                          NULL,
+                                          APP_DHT22_TASK_PRIORITY,
+                                          dht22_task_stack,
+                                          &dht22_task_buffer);
+
+    app_resources_register_queue("dht22", dht22_event_queue, APP_DHT22_EVENT_QUEUE_LEN, sizeof(dht22_event_t));
+    app_resources_register_task(dht22_task_handle, APP_DHT22_TASK_STACK_SIZE);
+    return true;
 }
 
-bool dht22_init(int gpio_pin) {
+bool dht22_new(const dht22_config_t *config, dht22_handle_t *ret_handle) {
+    if (config == NULL || ret_handle == NULL) {
+        return false;
+    }
+
+    int gpio_pin = config->gpio_pin;
     if (gpio_pin < 0 || gpio_pin > 47) {
         ESP_LOGE(TAG, "Invalid GPIO pin: %d", gpio_pin);
         return false;
     }
 
-    dht22_gpio_pin = gpio_pin;
+    if (!dht22_driver_start()) {
+        return false;
+    }
 
-    // Configure GPIO
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << gpio_pin),
-        .mode = GPIO_MODE_INPUT_OUTPUT_OD,  // Open drain for DHT22 protocol
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+    dht22_handle_t dev = NULL;
+    portENTER_CRITICAL(&dht22_lock);
+    for (int i = 0; i < DHT22_MAX_SENSORS; i++) {
+        if (dht22_devices[i].in_use && dht22_devices[i].gpio_pin == gpio_pin) {
+            dev = NULL;
+            break;
+        }
+        if (!dht22_devices[i].in_use && dev == NULL) {
+            dev = &dht22_devices[i];
+        }
+    }
+    if (dev != NULL) {
+        dev->in_use = true;
+    }
+    portEXIT_CRITICAL(&dht22_lock);
+
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "No free DHT22 slot for GPIO %d (max %d sensors, one per pin)", gpio_pin, DHT22_MAX_SENSORS);
+        return false;
+    }
+
+    dev->gpio_pin = gpio_pin;
+    dev->rx_channel = NULL;
+    dev->busy = false;
+    dev->pending = false;
+    dev->active = false;
+    // Give the sensor time to settle after power-up before the first transaction
+    dev->not_before = xTaskGetTickCount() + pdMS_TO_TICKS(DHT22_MIN_INTERVAL_MS);
+    dev->health = (dht22_health_t) {
+        .state = DHT22_HEALTH_UNKNOWN,
+        .last_error = DHT22_ERROR_NONE,
+        .min_bit_margin_us = UINT16_MAX,
+    };
+    dev->last_diag = (dht22_diag_t) { .error_bit = -1 };
+    dev->last_failure_diag = dev->last_diag;
+    dev->counters = (dht22_counters_t) { 0 };
+
+    // Timer that ends the host start signal without busy-waiting
+    esp_timer_create_args_t timer_args = {
+        .callback = dht22_start_timer_cb,
+        .arg = dev,
+        .name = "dht22_start",
     };
+    esp_err_t ret = esp_timer_create(&timer_args, &dev->start_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create start timer: %s", esp_err_to_name(ret));
+        dev->in_use = false;
+        return false;
+    }
 
-    esp_err_t ret = gpio_config(&io_conf);
+    ret = dht22_configure_gpio(gpio_pin);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure GPIO %d: %s", gpio_pin, esp_err_to_name(ret));
+        esp_timer_delete(dev->start_timer);
+        dev->in_use = false;
         return false;
     }
 
-    // Set pin high initially (idle state)
-    gpio_set_level(gpio_pin, 1);
-
-    dht22_initialized = true;
-    ESP_LOGI(TAG, "DHT22 initialized on GPIO %d", gpio_pin);
+    *ret_handle = dev;
+    ESP_LOGI(TAG, "DHT22 initialized on GPIO %d (RMT capture)", gpio_pin);
     return true;
 }
 
-bool dht22_read(dht22_reading_t *reading) {
-    if (!dht22_initialized || !reading) {
+bool dht22_delete(dht22_handle_t handle) {
+    if (handle == NULL || !handle->in_use) {
         return false;
     }
 
-    gpio_num_t pin = (gpio_num_t)dht22_gpio_pin;
+    portENTER_CRITICAL(&dht22_lock);
+    bool busy = handle->busy;
+    portEXIT_CRITICAL(&dht22_lock);
+    if (busy) {
+        ESP_LOGW(TAG, "GPIO %d: cannot delete sensor during a transaction", handle->gpio_pin);
+        return false;
+    }
 
-    // Send start signal
-    gpio_set_direction(pin, GPIO_MODE_OUTPUT);
-    gpio_set_level(pin, 0);  // Pull low
-    delay_us(DHT22_START_SIGNAL_LOW_US);
+    esp_timer_delete(handle->start_timer);
+    handle->start_timer = NULL;
+    handle->in_use = false;
+    return true;
+}
 
-    gpio_set_level(pin, 1);  // Release (pull-up will make it high)
-    delay_us(DHT22_START_SIGNAL_HIGH_US);
+bool dht22_read_async(dht22_handle_t handle, const dht22_read_options_t *options,
+                      dht22_read_cb_t callback, void *user_ctx) {
+    if (handle == NULL || !handle->in_use || !callback) {
+        return false;
+    }
 
-    // Switch to input mode
-    gpio_set_direction(pin, GPIO_MODE_INPUT);
+    uint8_t max_attempts = (options && options->max_attempts > 0) ? options->max_attempts : 1;
+    uint32_t timeout_ms = options ? options->timeout_ms : 0;
 
-    // Wait for DHT22 response
-    if (!dht22_wait_for_level(pin, 0, 100)) {
-        ESP_LOGW(TAG, "Timeout waiting for DHT22 response (low)");
+    portENTER_CRITICAL(&dht22_lock);
+    if (handle->busy) {
+        portEXIT_CRITICAL(&dht22_lock);
         return false;
     }
-
-    if (!dht22_wait_for_level(pin, 1, 100)) {
-        ESP_LOGW(TAG, "Timeout waiting for DHT22 response (high)");
+    handle->busy = true;
+    handle->callback = callback;
+    handle->callback_ctx = user_ctx;
+    handle->attempts_left = max_attempts;
+    handle->has_deadline = timeout_ms > 0;
+    handle->request_deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+    portEXIT_CRITICAL(&dht22_lock);
+
+    dht22_event_t event = {
+        .type = DHT22_EVENT_START,
+        .dev = handle,
+    };
+    if (xQueueSend(dht22_event_queue, &event, 0) != pdTRUE) {
+        portENTER_CRITICAL(&dht22_lock);
+        handle->busy = false;
+        handle->callback = NULL;
+        portEXIT_CRITICAL(&dht22_lock);
         return false;
     }
+    return true;
+}
 
-    // Read 40 bits of data
-    uint8_t data[5] = {0};
-    for (int byte = 0; byte < 5; byte++) {
-        for (int bit = 0; bit < 8; bit++) {
-            int bit_value = dht22_read_bit(pin);
-            if (bit_value < 0) {
-                ESP_LOGW(TAG, "Failed to read bit %d of byte %d", bit, byte);
-                return false;
-            }
-            data[byte] |= (bit_value << (7 - bit));
+static void dht22_blocking_read_cb(dht22_handle_t handle, const dht22_reading_t *reading, void *user_ctx)
+{
+    dht22_waiter_slot_t *slot = (dht22_waiter_slot_t *)user_ctx;
+    dht22_waiter_t *waiter = slot->waiter;
+
+    *slot->reading = *reading;
+
+    portENTER_CRITICAL(&waiter->lock);
+    bool last = (--waiter->remaining == 0);
+    portEXIT_CRITICAL(&waiter->lock);
+
+    if (last) {
+        xSemaphoreGive(waiter->done);
+    }
+}
+
+size_t dht22_read_many(const dht22_handle_t *handles, size_t count,
+                       const dht22_read_options_t *options, dht22_reading_t *readings) {
+    if (handles == NULL || readings == NULL || count == 0 || count > DHT22_MAX_SENSORS) {
+        return 0;
+    }
+
+    StaticSemaphore_t done_buffer;
+    dht22_waiter_t waiter = {
+        .done = xSemaphoreCreateBinaryStatic(&done_buffer),
+        .lock = portMUX_INITIALIZER_UNLOCKED,
+        .remaining = count,
+    };
+    dht22_waiter_slot_t slots[DHT22_MAX_SENSORS];
+
+    // Start every transaction before waiting so they overlap on the wire
+    for (size_t i = 0; i < count; i++) {
+        readings[i].valid = false;
+        readings[i].error = DHT22_ERROR_START;
+        slots[i].waiter = &waiter;
+        slots[i].reading = &readings[i];
+        if (!dht22_read_async(handles[i], options, dht22_blocking_read_cb, &slots[i])) {
+            ESP_LOGW(TAG, "Could not start DHT22 transaction %u", (unsigned)i);
+            portENTER_CRITICAL(&waiter.lock);
+            waiter.remaining--;
+            portEXIT_CRITICAL(&waiter.lock);
         }
     }
 
-    // Verify checksum
-    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
-    if (checksum != data[4]) {
-        ESP_LOGW(TAG, "DHT22 checksum failed: calculated %d, received %d", checksum, data[4]);
+    // The driver task always completes a transaction, at the latest on timeout
+    portENTER_CRITICAL(&waiter.lock);
+    bool outstanding = waiter.remaining > 0;
+    portEXIT_CRITICAL(&waiter.lock);
+    if (outstanding) {
+        xSemaphoreTake(waiter.done, portMAX_DELAY);
+    }
+    vSemaphoreDelete(waiter.done);
+
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (readings[i].valid) {
+            valid++;
+        }
+    }
+    return valid;
+}
+
+bool dht22_read(dht22_handle_t handle, const dht22_read_options_t *options, dht22_reading_t *reading) {
+    if (handle == NULL || reading == NULL) {
+        return false;
+    }
+    return dht22_read_many(&handle, 1, options, reading) == 1;
+}
+
+bool dht22_is_available(dht22_handle_t handle) {
+    if (handle == NULL || !handle->in_use) {
         return false;
     }
 
-    // Convert raw data to temperature and humidity
-    uint16_t raw_humidity = (data[0] << 8) | data[1];
-    uint16_t raw_temperature = (data[2] << 8) | data[3];
+    // A sensor that has not been read yet is assumed present until proven otherwise
+    portENTER_CRITICAL(&dht22_lock);
+    bool available = handle->health.state != DHT22_HEALTH_FAILED;
+    portEXIT_CRITICAL(&dht22_lock);
+    return available;
+}
+
+bool dht22_get_health(dht22_handle_t handle, dht22_health_t *health) {
+    if (handle == NULL || !handle->in_use || health == NULL) {
+        return false;
+    }
 
-    reading->humidity_percent = raw_humidity / 10.0f;
+    portENTER_CRITICAL(&dht22_lock);
+    *health = handle->health;
+    portEXIT_CRITICAL(&dht22_lock);
+    return true;
+}
 
-    // Handle negative temperatures (MSB of temperature indicates sign)
-    if (raw_temperature & 0x8000) {
-        reading->temperature_c = -(raw_temperature & 0x7FFF) / 10.0f;
-    } else {
-        reading->temperature_c = raw_temperature / 10.0f;
+bool dht22_get_diagnostics(dht22_handle_t handle, dht22_diag_t *last, dht22_diag_t *last_failure) {
+    if (handle == NULL || !handle->in_use) {
+        return false;
     }
 
-    reading->valid = true;
+    portENTER_CRITICAL(&dht22_lock);
+    if (last) {
+        *last = handle->last_diag;
+    }
+    if (last_failure) {
+        *last_failure = handle->last_failure_diag;
+    }
+    portEXIT_CRITICAL(&dht22_lock);
+    return true;
+}
 
-    ESP_LOGD(TAG, "DHT22 reading: Temperature=%.1f°C, Humidity=%.1f%%",
-             reading->temperature_c, reading->humidity_percent);
+bool dht22_get_counters(dht22_handle_t handle, dht22_counters_t *counters) {
+    if (handle == NULL || !handle->in_use || counters == NULL) {
+        return false;
+    }
 
+    portENTER_CRITICAL(&dht22_lock);
+    *counters = handle->counters;
+    portEXIT_CRITICAL(&dht22_lock);
     return true;
 }
 
-bool dht22_is_available(void) {
-    if (!dht22_initialized) {
+bool dht22_reset_counters(dht22_handle_t handle) {
+    if (handle == NULL || !handle->in_use) {
         return false;
     }
 
-    // Try a quick read to test if sensor is responding
-    dht22_reading_t test_reading;
-    return dht22_read(&test_reading);
-}
\ No newline at end of file
+    portENTER_CRITICAL(&dht22_lock);
+    handle->counters = (dht22_counters_t) { 0 };
+    portEXIT_CRITICAL(&dht22_lock);
+    return true;
+}
+
+const char *dht22_error_to_name(dht22_error_t error) {
+    switch (error) {
+        case DHT22_ERROR_NONE:
+            return "none";
+        case DHT22_ERROR_START:
+            return "start";
+        case DHT22_ERROR_TIMEOUT:
+            return "timeout";
+        case DHT22_ERROR_INCOMPLETE:
+            return "incomplete frame";
+        case DHT22_ERROR_RESPONSE_LOW:
+            return "response low";
+        case DHT22_ERROR_RESPONSE_HIGH:
+            return "response high";
+        case DHT22_ERROR_BIT_LOW:
+            return "bit low";
+        case DHT22_ERROR_BIT_HIGH:
+            return "bit high";
+        case DHT22_ERROR_CHECKSUM:
+            return "checksum";
+        case DHT22_ERROR_RANGE:
+            return "range";
+        case DHT22_ERROR_DEADLINE:
+            return "deadline";
+        default:
+            return "unknown";
+    }
+}
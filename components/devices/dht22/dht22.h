@@ -1,24 +1,139 @@
 /*
  * DHT22 Temperature and Humidity Sensor Driver
  *
- * Driver for DHT22 sensor providing temperature and humidity readings
+ * Driver for DHT22 sensors providing temperature and humidity readings.
+ * Each sensor is a separate handle on its own GPIO; transactions on
+ * different handles run concurrently.
  */
 
 #ifndef DHT22_H
 #define DHT22_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DHT22_MAX_SENSORS 4
+#define DHT22_HEALTH_FAILURE_THRESHOLD 3    // Consecutive failures before a sensor is reported unavailable
+#define DHT22_LOW_MARGIN_US 8                // Bit decision margin below which a link is flagged as marginal
+
+// Stage at which a transaction failed
+typedef enum {
+    DHT22_ERROR_NONE,
+    DHT22_ERROR_START,           // RMT channel, timer or capture could not be set up
+    DHT22_ERROR_TIMEOUT,         // No complete frame within the transaction timeout, or no RMT channel before the deadline
+    DHT22_ERROR_INCOMPLETE,      // Frame ended early or missed edges
+    DHT22_ERROR_RESPONSE_LOW,    // Sensor response low pulse out of range
+    DHT22_ERROR_RESPONSE_HIGH,   // Sensor response high pulse out of range
+    DHT22_ERROR_BIT_LOW,         // Data bit low phase out of range
+    DHT22_ERROR_BIT_HIGH,        // Data bit high phase out of range
+    DHT22_ERROR_CHECKSUM,        // All bits received, checksum mismatch
+    DHT22_ERROR_RANGE,           // Valid frame with values outside the sensor's range
+    DHT22_ERROR_DEADLINE,        // Request deadline passed before a transaction could run
+    DHT22_ERROR_MAX,
+} dht22_error_t;
+
+// Cached sensor health, updated after every transaction
+typedef enum {
+    DHT22_HEALTH_UNKNOWN,        // No transaction completed yet
+    DHT22_HEALTH_OK,             // Last transaction succeeded
+    DHT22_HEALTH_DEGRADED,       // Recent failures, below the threshold
+    DHT22_HEALTH_FAILED,         // DHT22_HEALTH_FAILURE_THRESHOLD or more consecutive failures
+} dht22_health_state_t;
+
+typedef struct {
+    dht22_health_state_t state;
+    int64_t last_success_us;         // esp_timer time of the last good frame, 0 if none
+    int64_t last_attempt_us;         // esp_timer time of the last completed transaction, 0 if none
+    uint32_t consecutive_failures;
+    dht22_error_t last_error;        // Failure stage of the most recent failed transaction
+
+    // Bit classifier telemetry from decoded frames
+    uint16_t last_bit_threshold_us;  // Threshold the last frame was classified with
+    uint16_t last_bit_margin_us;     // Closest bit to the threshold in the last frame
+    uint16_t min_bit_margin_us;      // Worst margin seen since the sensor was created
+    uint32_t low_margin_frames;      // Frames decoded with a margin below DHT22_LOW_MARGIN_US
+} dht22_health_t;
+
+// Diagnostics of a single transaction
+typedef struct {
+    uint32_t seq;                    // Transaction number on this sensor
+    int64_t timestamp_us;            // esp_timer time at completion
+    uint8_t attempt;                 // Attempt within its request, starting at 1
+    dht22_error_t error;
+    int8_t error_bit;                // Failing bit 0-39 (byte = bit / 8) for bit errors, -1 otherwise
+    uint16_t error_pulse_us;         // Offending pulse width for timing errors
+
+    // Phase durations in microseconds, 0 if the phase was not reached
+    uint32_t start_signal_us;        // Host start signal
+    uint32_t capture_us;             // Capture armed until end of frame
+    uint16_t response_low_us;
+    uint16_t response_high_us;
+    uint16_t data_us;                // All 40 data bits
+
+    uint16_t num_edges;              // Edges captured by the RMT
+    uint16_t bit_threshold_us;
+    uint16_t bit_margin_us;
+    uint8_t raw[5];                  // Bytes as received, including checksum
+} dht22_diag_t;
+
+// Counters accumulated since creation or the last reset
+typedef struct {
+    uint32_t requests;               // Completed read requests
+    uint32_t request_failures;       // Requests that ended without a reading
+    uint32_t transactions;           // Transactions on the wire, including retries
+    uint32_t retries;
+    uint32_t successes;
+    uint32_t errors[DHT22_ERROR_MAX];    // Failed transactions (or requests, for DEADLINE) by stage
+    uint32_t max_start_signal_us;    // Longest start signal; esp_timer dispatch latency stretches it
+    uint32_t max_capture_us;
+} dht22_counters_t;
 
 // DHT22 sensor data structure
 typedef struct {
-    float temperature_c;
-    float humidity_percent;
+    int16_t temperature_centi_c;     // Temperature in 0.01 °C
+    uint16_t humidity_centi_pct;     // Relative humidity in 0.01 %
     bool valid;
+    dht22_error_t error;         // Failure stage when valid is false
 } dht22_reading_t;
 
+// DHT22 sensor configuration
+typedef struct {
+    int gpio_pin;
+} dht22_config_t;
+
+// Per-request retry policy. Retries honour the sensor's 2 s minimum spacing,
+// and no attempt is started that could not finish before the deadline.
+typedef struct {
+    uint8_t max_attempts;        // Total attempts including the first; 0 is treated as 1
+    uint32_t timeout_ms;         // Request deadline relative to the call; 0 for none
+} dht22_read_options_t;
+
+// Opaque sensor handle
+typedef struct dht22_dev_t *dht22_handle_t;
+
+// Completion callback for asynchronous reads.
+// Runs in the DHT22 driver task; reading->valid is false if the transaction failed.
+typedef void (*dht22_read_cb_t)(dht22_handle_t handle, const dht22_reading_t *reading, void *user_ctx);
+
 // DHT22 driver functions
-bool dht22_init(int gpio_pin);
-bool dht22_read(dht22_reading_t *reading);
-bool dht22_is_available(void);
+bool dht22_new(const dht22_config_t *config, dht22_handle_t *ret_handle);
+bool dht22_delete(dht22_handle_t handle);
+// Reads accept NULL options for a single attempt without deadline
+bool dht22_read(dht22_handle_t handle, const dht22_read_options_t *options, dht22_reading_t *reading);
+// Start a request and return immediately; false if one is already in progress on this handle
+bool dht22_read_async(dht22_handle_t handle, const dht22_read_options_t *options,
+                      dht22_read_cb_t callback, void *user_ctx);
+// Read several sensors with overlapping transactions; returns the number of valid readings
+size_t dht22_read_many(const dht22_handle_t *handles, size_t count,
+                       const dht22_read_options_t *options, dht22_reading_t *readings);
+// O(1) liveness check from the cached health state; never touches the bus
+bool dht22_is_available(dht22_handle_t handle);
+bool dht22_get_health(dht22_handle_t handle, dht22_health_t *health);
+// Diagnostics of the most recent transaction and of the most recent failed one
+bool dht22_get_diagnostics(dht22_handle_t handle, dht22_diag_t *last, dht22_diag_t *last_failure);
+bool dht22_get_counters(dht22_handle_t handle, dht22_counters_t *counters);
+bool dht22_reset_counters(dht22_handle_t handle);
+const char *dht22_error_to_name(dht22_error_t error);
 
-#endif // DHT22_H
\ No newline at end of file
+#endif // DHT22_H
@@ -0,0 +1,221 @@
+/*
+ * DHT22 Frame Decoder Implementation
+ *
+ * Converts edge timestamps into pulse widths and decodes the 40-bit frame
+ */
+
+#include "dht22_decode.h"
+
+// Timing constants for DHT22 protocol (microseconds)
+#define DHT22_RESPONSE_LOW_US 80
+#define DHT22_RESPONSE_HIGH_US 80
+#define DHT22_BIT_LOW_US 50
+#define DHT22_BIT_0_HIGH_US 26
+#define DHT22_BIT_1_HIGH_US 70
+#define DHT22_BIT_THRESHOLD_US ((DHT22_BIT_0_HIGH_US + DHT22_BIT_1_HIGH_US) / 2)
+#define DHT22_PULSE_MIN_US 10     // Shortest pulse accepted as part of a frame
+#define DHT22_PULSE_MAX_US 120    // Longest pulse accepted as part of a frame
+
+// Classifier tuning
+#define DHT22_BIT_MIN_SEPARATION_US 20   // Narrower spread means all bits share one value
+#define DHT22_CLASSIFIER_ITERATIONS 4
+
+static inline uint32_t pulse_width(const uint32_t *edges_us, size_t index)
+{
+    return edges_us[index + 1] - edges_us[index];
+}
+
+static inline int pulse_in_range(uint32_t width)
+{
+    return width >= DHT22_PULSE_MIN_US && width <= DHT22_PULSE_MAX_US;
+}
+
+static inline uint16_t clamp_u16(uint32_t value)
+{
+    return value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+}
+
+// Split the bimodal high-width distribution into 0 and 1 bits.
+// Falls back to the nominal threshold when the frame has only one cluster.
+static void classify_bits(const uint16_t *high_us, dht22_frame_t *frame)
+{
+    uint16_t min_us = UINT16_MAX;
+    uint16_t max_us = 0;
+    for (int bit = 0; bit < DHT22_DATA_BITS; bit++) {
+        if (high_us[bit] < min_us) {
+            min_us = high_us[bit];
+        }
+        if (high_us[bit] > max_us) {
+            max_us = high_us[bit];
+        }
+    }
+
+    uint32_t threshold = DHT22_BIT_THRESHOLD_US;
+    uint32_t zero_sum = 0, zero_count = 0;
+    uint32_t one_sum = 0, one_count = 0;
+    bool calibrated = (max_us - min_us) >= DHT22_BIT_MIN_SEPARATION_US;
+
+    if (calibrated) {
+        threshold = ((uint32_t)min_us + max_us) / 2;
+        for (int iter = 0; iter < DHT22_CLASSIFIER_ITERATIONS; iter++) {
+            zero_sum = zero_count = one_sum = one_count = 0;
+            for (int bit = 0; bit < DHT22_DATA_BITS; bit++) {
+                if (high_us[bit] > threshold) {
+                    one_sum += high_us[bit];
+                    one_count++;
+                } else {
+                    zero_sum += high_us[bit];
+                    zero_count++;
+                }
+            }
+            uint32_t next = (zero_sum / zero_count + one_sum / one_count) / 2;
+            if (next == threshold) {
+                break;
+            }
+            threshold = next;
+        }
+    }
+
+    uint32_t margin = UINT16_MAX;
+    zero_sum = zero_count = one_sum = one_count = 0;
+    for (int bit = 0; bit < DHT22_DATA_BITS; bit++) {
+        uint32_t distance;
+        if (high_us[bit] > threshold) {
+            frame->data[bit / 8] |= (uint8_t)(1 << (7 - (bit % 8)));
+            one_sum += high_us[bit];
+            one_count++;
+            distance = high_us[bit] - threshold;
+        } else {
+            zero_sum += high_us[bit];
+            zero_count++;
+            distance = threshold - high_us[bit];
+        }
+        if (distance < margin) {
+            margin = distance;
+        }
+    }
+
+    frame->bit_threshold_us = (uint16_t)threshold;
+    frame->bit_margin_us = (uint16_t)margin;
+    frame->zero_high_us = zero_count ? (uint16_t)(zero_sum / zero_count) : 0;
+    frame->one_high_us = one_count ? (uint16_t)(one_sum / one_count) : 0;
+    frame->calibrated = calibrated;
+}
+
+dht22_decode_status_t dht22_decode_edges(const uint32_t *edges_us, size_t num_edges,
+                                         int first_level, dht22_frame_t *frame)
+{
+    if (edges_us == NULL || frame == NULL || num_edges == 0) {
+        return DHT22_DECODE_ERR_ARG;
+    }
+
+    for (int i = 0; i < DHT22_DATA_BYTES; i++) {
+        frame->data[i] = 0;
+    }
+    frame->humidity_deci_pct = 0;
+    frame->temperature_deci_c = 0;
+    frame->error_bit = -1;
+    frame->error_pulse_us = 0;
+    frame->response_low_us = 0;
+    frame->response_high_us = 0;
+    frame->data_us = 0;
+    frame->bit_threshold_us = 0;
+    frame->bit_margin_us = 0;
+    frame->zero_high_us = 0;
+    frame->one_high_us = 0;
+    frame->calibrated = false;
+
+    // Pulse i spans edges i..i+1 and has level first_level ^ (i & 1).
+    // The last pulse must be the trailing low of the frame.
+    size_t num_pulses = num_edges - 1;
+    if (num_pulses < DHT22_FRAME_PULSES || (((first_level != 0) ^ (num_pulses - 1)) & 1) != 0) {
+        return DHT22_DECODE_ERR_INCOMPLETE;
+    }
+    size_t start = num_pulses - DHT22_FRAME_PULSES;
+
+    // Response: ~80 us low followed by ~80 us high
+    uint32_t width = pulse_width(edges_us, start);
+    frame->response_low_us = clamp_u16(width);
+    if (!pulse_in_range(width)) {
+        frame->error_pulse_us = clamp_u16(width);
+        return DHT22_DECODE_ERR_RESPONSE_LOW;
+    }
+    width = pulse_width(edges_us, start + 1);
+    frame->response_high_us = clamp_u16(width);
+    if (!pulse_in_range(width)) {
+        frame->error_pulse_us = clamp_u16(width);
+        return DHT22_DECODE_ERR_RESPONSE_HIGH;
+    }
+
+    // Each bit is a ~50 us low followed by a high whose width encodes the value
+    uint16_t high_us[DHT22_DATA_BITS];
+    for (int bit = 0; bit < DHT22_DATA_BITS; bit++) {
+        size_t index = start + 2 + 2 * (size_t)bit;
+        uint32_t low_time = pulse_width(edges_us, index);
+        uint32_t high_time = pulse_width(edges_us, index + 1);
+        if (!pulse_in_range(low_time)) {
+            frame->error_bit = (int8_t)bit;
+            frame->error_pulse_us = clamp_u16(low_time);
+            return DHT22_DECODE_ERR_BIT_LOW;
+        }
+        if (!pulse_in_range(high_time)) {
+            frame->error_bit = (int8_t)bit;
+            frame->error_pulse_us = clamp_u16(high_time);
+            return DHT22_DECODE_ERR_BIT_HIGH;
+        }
+        high_us[bit] = (uint16_t)high_time;
+    }
+    frame->data_us = clamp_u16(edges_us[start + 2 + 2 * DHT22_DATA_BITS] - edges_us[start + 2]);
+
+    classify_bits(high_us, frame);
+
+    // Verify checksum
+    uint8_t checksum = frame->data[0] + frame->data[1] + frame->data[2] + frame->data[3];
+    if (checksum != frame->data[4]) {
+        return DHT22_DECODE_ERR_CHECKSUM;
+    }
+
+    // Convert raw data; MSB of temperature indicates sign
+    uint16_t raw_temperature = (uint16_t)((frame->data[2] << 8) | frame->data[3]);
+    frame->humidity_deci_pct = (uint16_t)((frame->data[0] << 8) | frame->data[1]);
+    frame->temperature_deci_c = (int16_t)(raw_temperature & 0x7FFF);
+    if (raw_temperature & 0x8000) {
+        frame->temperature_deci_c = -frame->temperature_deci_c;
+    }
+
+    // A frame with a good checksum can still carry garbage, e.g. from a
+    // failing sensor; reject it before callers scale it
+    if (frame->humidity_deci_pct > DHT22_HUMIDITY_MAX_DECI_PCT ||
+        frame->temperature_deci_c < DHT22_TEMPERATURE_MIN_DECI_C ||
+        frame->temperature_deci_c > DHT22_TEMPERATURE_MAX_DECI_C) {
+        return DHT22_DECODE_ERR_RANGE;
+    }
+
+    return DHT22_DECODE_OK;
+}
+
+const char *dht22_decode_status_to_name(dht22_decode_status_t status)
+{
+    switch (status) {
+        case DHT22_DECODE_OK:
+            return "ok";
+        case DHT22_DECODE_ERR_ARG:
+            return "invalid argument";
+        case DHT22_DECODE_ERR_INCOMPLETE:
+            return "incomplete frame";
+        case DHT22_DECODE_ERR_RESPONSE_LOW:
+            return "response low out of range";
+        case DHT22_DECODE_ERR_RESPONSE_HIGH:
+            return "response high out of range";
+        case DHT22_DECODE_ERR_BIT_LOW:
+            return "bit low out of range";
+        case DHT22_DECODE_ERR_BIT_HIGH:
+            return "bit high out of range";
+        case DHT22_DECODE_ERR_CHECKSUM:
+            return "checksum mismatch";
+        case DHT22_DECODE_ERR_RANGE:
+            return "value out of range";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * DHT22 Frame Decoder
+ *
+ * Pure protocol decoder for DHT22 frames. Takes the edge timestamps of a
+ * captured frame and returns the measurement or a precise error code.
+ * Has no hardware or ESP-IDF dependencies so it also builds on a host.
+ */
+
+#ifndef DHT22_DECODE_H
+#define DHT22_DECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define DHT22_DATA_BITS 40        // 5 bytes * 8 bits
+#define DHT22_DATA_BYTES 5
+
+// Response low/high + 40 bits (low/high each) + trailing low
+#define DHT22_FRAME_PULSES (2 + 2 * DHT22_DATA_BITS + 1)
+#define DHT22_FRAME_EDGES (DHT22_FRAME_PULSES + 1)
+
+// Measurement range of the sensor; frames outside it are rejected
+#define DHT22_HUMIDITY_MAX_DECI_PCT 1000
+#define DHT22_TEMPERATURE_MIN_DECI_C (-400)
+#define DHT22_TEMPERATURE_MAX_DECI_C 800
+
+// Decoder result codes
+typedef enum {
+    DHT22_DECODE_OK,
+    DHT22_DECODE_ERR_ARG,              // NULL pointer or no edges
+    DHT22_DECODE_ERR_INCOMPLETE,       // Fewer edges than a full frame, or frame not ending low
+    DHT22_DECODE_ERR_RESPONSE_LOW,     // Sensor response low pulse out of range
+    DHT22_DECODE_ERR_RESPONSE_HIGH,    // Sensor response high pulse out of range
+    DHT22_DECODE_ERR_BIT_LOW,          // Bit low phase out of range (see error_bit)
+    DHT22_DECODE_ERR_BIT_HIGH,         // Bit high phase out of range (see error_bit)
+    DHT22_DECODE_ERR_CHECKSUM,         // All bits read, checksum mismatch
+    DHT22_DECODE_ERR_RANGE,            // Checksum valid, values outside the sensor's range
+} dht22_decode_status_t;
+
+// Decoded frame
+typedef struct {
+    uint8_t data[DHT22_DATA_BYTES];    // Raw bytes as received (zero if a timing error stopped decoding)
+    uint16_t humidity_deci_pct;        // Relative humidity in 0.1 % (set for OK and RANGE)
+    int16_t temperature_deci_c;        // Temperature in 0.1 °C, sign applied (set for OK and RANGE)
+    int8_t error_bit;                  // Failing bit index (0-39) for bit errors, -1 otherwise
+    uint16_t error_pulse_us;           // Offending pulse width for timing errors
+
+    // Measured phase durations (0 if the phase was not reached)
+    uint16_t response_low_us;
+    uint16_t response_high_us;
+    uint16_t data_us;                  // All 40 data bits
+
+    // Bit classifier telemetry (valid once all 40 bits passed the range checks)
+    uint16_t bit_threshold_us;         // High-phase width separating 0 from 1 for this frame
+    uint16_t bit_margin_us;            // Smallest distance of any bit from the threshold
+    uint16_t zero_high_us;             // Mean high width of 0 bits (0 if the frame had none)
+    uint16_t one_high_us;              // Mean high width of 1 bits (0 if the frame had none)
+    bool calibrated;                   // Threshold derived from this frame rather than the nominal one
+} dht22_frame_t;
+
+/*
+ * Decode a frame from edge timestamps.
+ *
+ * Bits are classified from the frame's own high-phase widths: the two
+ * clusters (0 bits near 26 us, 1 bits near 70 us) are split with a small
+ * 2-means iteration, so slow edges on long or cold cables shift the
+ * threshold with them. The resulting margin is reported in the frame.
+ *
+ * edges_us:    timestamps of consecutive line transitions in microseconds
+ *              (may wrap; only differences are used)
+ * num_edges:   number of timestamps
+ * first_level: line level right after edges_us[0]
+ *
+ * The frame is located from the end of the trace, so leading edges from the
+ * host start signal are ignored. The last edge must be the rising edge that
+ * ends the trailing low pulse.
+ */
+dht22_decode_status_t dht22_decode_edges(const uint32_t *edges_us, size_t num_edges,
+                                         int first_level, dht22_frame_t *frame);
+
+// Human-readable name for a decoder result
+const char *dht22_decode_status_to_name(dht22_decode_status_t status);
+
+#endif // DHT22_DECODE_H
@@ -0,0 +1,415 @@
+/*
+ * HC-SR04 Ultrasonic Distance Sensor Driver Implementation
+ *
+ * A measurement is a sequence of pings. Each ping raises the trigger for
+ * 10 us and arms the echo capture; the MCPWM capture channel timestamps
+ * both echo edges in hardware, and a one-shot timer closes the ping's echo
+ * window and starts the next one. The last window computes the median.
+ */
+
+#include "hcsr04.h"
+#include "hcsr04_echo.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "driver/mcpwm_cap.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "timing.h"
+
+static const char *TAG = "HCSR04";
+
+#define HCSR04_TRIGGER_US 10
+#define HCSR04_CAPTURE_GROUP 0
+
+struct hcsr04_dev_t {
+    bool in_use;
+    int trigger_pin;
+    int echo_pin;
+    uint16_t max_distance_mm;
+    mcpwm_cap_channel_handle_t cap_channel;
+    esp_timer_handle_t ping_timer;
+
+    // Request state, guarded by hcsr04_lock
+    bool busy;
+    hcsr04_measure_cb_t callback;
+    void *callback_ctx;
+
+    // Measurement state, owned by the ping sequence
+    uint8_t pings;
+    uint8_t ping;
+    uint32_t sound_mm_s;
+    uint32_t max_echo_us;
+    uint8_t echoes;
+    uint16_t echo_us[HCSR04_MAX_PINGS];
+
+    // Capture state, written from the capture ISR under hcsr04_lock
+    bool armed;
+    bool rise_seen;
+    bool echo_seen;
+    uint32_t rise_ticks;
+    uint32_t echo_ticks;
+};
+
+static struct hcsr04_dev_t hcsr04_devices[HCSR04_MAX_SENSORS];
+static portMUX_TYPE hcsr04_lock = portMUX_INITIALIZER_UNLOCKED;
+static mcpwm_cap_timer_handle_t hcsr04_cap_timer = NULL;
+static uint32_t hcsr04_cap_resolution_hz = 0;
+
+static bool hcsr04_capture_cb(mcpwm_cap_channel_handle_t channel, const mcpwm_capture_event_data_t *edata,
+                              void *user_ctx)
+{
+    hcsr04_handle_t dev = (hcsr04_handle_t)user_ctx;
+
+    portENTER_CRITICAL_ISR(&hcsr04_lock);
+    if (dev->armed) {
+        if (edata->cap_edge == MCPWM_CAP_EDGE_POS) {
+            dev->rise_ticks = edata->cap_value;
+            dev->rise_seen = true;
+        } else if (dev->rise_seen) {
+            // The capture counter wraps; the unsigned difference stays correct
+            dev->echo_ticks = edata->cap_value - dev->rise_ticks;
+            dev->echo_seen = true;
+            dev->armed = false;
+        }
+    }
+    portEXIT_CRITICAL_ISR(&hcsr04_lock);
+    return false;
+}
+
+static bool hcsr04_ping_start(hcsr04_handle_t dev)
+{
+    portENTER_CRITICAL(&hcsr04_lock);
+    dev->rise_seen = false;
+    dev->echo_seen = false;
+    dev->armed = true;
+    portEXIT_CRITICAL(&hcsr04_lock);
+
+    gpio_set_level(dev->trigger_pin, 1);
+    timing_delay_us(HCSR04_TRIGGER_US);
+    gpio_set_level(dev->trigger_pin, 0);
+
+    return esp_timer_start_once(dev->ping_timer, HCSR04_PING_INTERVAL_MS * 1000) == ESP_OK;
+}
+
+static void hcsr04_complete(hcsr04_handle_t dev, const hcsr04_reading_t *reading)
+{
+    portENTER_CRITICAL(&hcsr04_lock);
+    hcsr04_measure_cb_t callback = dev->callback;
+    void *callback_ctx = dev->callback_ctx;
+    dev->callback = NULL;
+    dev->busy = false;
+    portEXIT_CRITICAL(&hcsr04_lock);
+
+    if (callback != NULL) {
+        callback(dev, reading, callback_ctx);
+    }
+}
+
+static void hcsr04_finish(hcsr04_handle_t dev)
+{
+    hcsr04_reading_t reading = {
+        .echoes = dev->echoes,
+        .valid = false,
+        .error = HCSR04_ERROR_NONE,
+    };
+
+    if (dev->echoes == 0) {
+        reading.error = HCSR04_ERROR_NO_ECHO;
+    } else if (dev->echoes * 2 < dev->pings) {
+        // A lone echo among misses is more likely a reflection than the target
+        reading.error = HCSR04_ERROR_UNSTABLE;
+    } else {
+        reading.echo_us = hcsr04_echo_median(dev->echo_us, dev->echoes);
+        reading.distance_mm = hcsr04_echo_distance_mm(reading.echo_us, dev->sound_mm_s);
+        reading.valid = true;
+    }
+
+    hcsr04_complete(dev, &reading);
+}
+
+// Closes a ping's echo window; runs in the esp_timer task
+static void hcsr04_ping_timer_cb(void *arg)
+{
+    hcsr04_handle_t dev = (hcsr04_handle_t)arg;
+
+    portENTER_CRITICAL(&hcsr04_lock);
+    dev->armed = false;
+    bool echo_seen = dev->echo_seen;
+    uint32_t echo_ticks = dev->echo_ticks;
+    portEXIT_CRITICAL(&hcsr04_lock);
+
+    if (echo_seen) {
+        uint32_t echo_us = (uint32_t)((uint64_t)echo_ticks * 1000000 / hcsr04_cap_resolution_hz);
+        if (echo_us <= dev->max_echo_us) {
+            dev->echo_us[dev->echoes++] = (uint16_t)echo_us;
+        }
+    }
+
+    dev->ping++;
+    if (dev->ping < dev->pings) {
+        if (hcsr04_ping_start(dev)) {
+            return;
+        }
+        ESP_LOGW(TAG, "Echo GPIO %d: failed to start ping %d", dev->echo_pin, dev->ping + 1);
+        dev->pings = dev->ping;
+    }
+    hcsr04_finish(dev);
+}
+
+// Capture timer shared by all sensors; each sensor uses one of its channels
+static bool hcsr04_driver_start(void)
+{
+    if (hcsr04_cap_timer != NULL) {
+        return true;
+    }
+
+    mcpwm_capture_timer_config_t timer_conf = {
+        .group_id = HCSR04_CAPTURE_GROUP,
+        .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT,
+    };
+    esp_err_t ret = mcpwm_new_capture_timer(&timer_conf, &hcsr04_cap_timer);
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_timer_get_resolution(hcsr04_cap_timer, &hcsr04_cap_resolution_hz);
+    }
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_timer_enable(hcsr04_cap_timer);
+    }
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_timer_start(hcsr04_cap_timer);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start capture timer: %s", esp_err_to_name(ret));
+        if (hcsr04_cap_timer != NULL) {
+            mcpwm_capture_timer_disable(hcsr04_cap_timer);
+            mcpwm_del_capture_timer(hcsr04_cap_timer);
+            hcsr04_cap_timer = NULL;
+        }
+        return false;
+    }
+    return true;
+}
+
+static esp_err_t hcsr04_configure_trigger(int gpio_pin)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << gpio_pin),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret == ESP_OK) {
+        gpio_set_level(gpio_pin, 0);
+    }
+    return ret;
+}
+
+static esp_err_t hcsr04_acquire_channel(hcsr04_handle_t dev)
+{
+    mcpwm_capture_channel_config_t channel_conf = {
+        .gpio_num = dev->echo_pin,
+        .prescale = 1,
+        .flags.pos_edge = true,
+        .flags.neg_edge = true,
+        .flags.pull_down = true,     // Echo idles low; keep an unplugged sensor quiet
+    };
+
+    esp_err_t ret = mcpwm_new_capture_channel(hcsr04_cap_timer, &channel_conf, &dev->cap_channel);
+    if (ret != ESP_OK) {
+        dev->cap_channel = NULL;
+        return ret;
+    }
+
+    mcpwm_capture_event_callbacks_t cbs = {
+        .on_cap = hcsr04_capture_cb,
+    };
+    ret = mcpwm_capture_channel_register_event_callbacks(dev->cap_channel, &cbs, dev);
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_channel_enable(dev->cap_channel);
+    }
+    if (ret != ESP_OK) {
+        mcpwm_del_capture_channel(dev->cap_channel);
+        dev->cap_channel = NULL;
+    }
+    return ret;
+}
+
+bool hcsr04_new(const hcsr04_config_t *config, hcsr04_handle_t *ret_handle) {
+    if (config == NULL || ret_handle == NULL) {
+        return false;
+    }
+
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(config->trigger_pin) || !GPIO_IS_VALID_GPIO(config->echo_pin) ||
+        config->trigger_pin == config->echo_pin) {
+        ESP_LOGE(TAG, "Invalid GPIO pins: trigger %d, echo %d", config->trigger_pin, config->echo_pin);
+        return false;
+    }
+
+    if (!hcsr04_driver_start()) {
+        return false;
+    }
+
+    hcsr04_handle_t dev = NULL;
+    portENTER_CRITICAL(&hcsr04_lock);
+    for (int i = 0; i < HCSR04_MAX_SENSORS; i++) {
+        if (!hcsr04_devices[i].in_use) {
+            dev = &hcsr04_devices[i];
+            dev->in_use = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&hcsr04_lock);
+
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "No free HC-SR04 slot (max %d sensors)", HCSR04_MAX_SENSORS);
+        return false;
+    }
+
+    dev->trigger_pin = config->trigger_pin;
+    dev->echo_pin = config->echo_pin;
+    dev->max_distance_mm = config->max_distance_mm ? config->max_distance_mm : HCSR04_DEFAULT_MAX_DISTANCE_MM;
+    dev->busy = false;
+    dev->callback = NULL;
+    dev->armed = false;
+
+    esp_timer_create_args_t timer_args = {
+        .callback = hcsr04_ping_timer_cb,
+        .arg = dev,
+        .name = "hcsr04_ping",
+    };
+    esp_err_t ret = hcsr04_configure_trigger(dev->trigger_pin);
+    if (ret == ESP_OK) {
+        ret = hcsr04_acquire_channel(dev);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_timer_create(&timer_args, &dev->ping_timer);
+        if (ret != ESP_OK) {
+            mcpwm_capture_channel_disable(dev->cap_channel);
+            mcpwm_del_capture_channel(dev->cap_channel);
+            dev->cap_channel = NULL;
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up sensor on trigger %d, echo %d: %s",
+                 dev->trigger_pin, dev->echo_pin, esp_err_to_name(ret));
+        dev->in_use = false;
+        return false;
+    }
+
+    ESP_LOGI(TAG, "HC-SR04 ready on trigger GPIO %d, echo GPIO %d", dev->trigger_pin, dev->echo_pin);
+    *ret_handle = dev;
+    return true;
+}
+
+bool hcsr04_delete(hcsr04_handle_t handle) {
+    if (handle == NULL || !handle->in_use) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&hcsr04_lock);
+    bool busy = handle->busy;
+    portEXIT_CRITICAL(&hcsr04_lock);
+    if (busy) {
+        ESP_LOGW(TAG, "Echo GPIO %d: cannot delete sensor during a measurement", handle->echo_pin);
+        return false;
+    }
+
+    esp_timer_delete(handle->ping_timer);
+    handle->ping_timer = NULL;
+    mcpwm_capture_channel_disable(handle->cap_channel);
+    mcpwm_del_capture_channel(handle->cap_channel);
+    handle->cap_channel = NULL;
+    handle->in_use = false;
+    return true;
+}
+
+bool hcsr04_measure_async(hcsr04_handle_t handle, const hcsr04_measure_options_t *options,
+                          hcsr04_measure_cb_t callback, void *user_ctx) {
+    if (handle == NULL || !handle->in_use) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&hcsr04_lock);
+    bool busy = handle->busy;
+    if (!busy) {
+        handle->busy = true;
+        handle->callback = callback;
+        handle->callback_ctx = user_ctx;
+    }
+    portEXIT_CRITICAL(&hcsr04_lock);
+    if (busy) {
+        return false;
+    }
+
+    uint8_t pings = options && options->pings ? options->pings : HCSR04_DEFAULT_PINGS;
+    int16_t temperature = options ? options->temperature_centi_c : HCSR04_DEFAULT_TEMPERATURE_CENTI_C;
+    handle->pings = pings > HCSR04_MAX_PINGS ? HCSR04_MAX_PINGS : pings;
+    handle->ping = 0;
+    handle->echoes = 0;
+    handle->sound_mm_s = hcsr04_speed_of_sound_mm_s(temperature);
+    handle->max_echo_us = hcsr04_max_echo_us(handle->max_distance_mm, handle->sound_mm_s);
+
+    if (!hcsr04_ping_start(handle)) {
+        ESP_LOGW(TAG, "Echo GPIO %d: failed to start measurement", handle->echo_pin);
+        portENTER_CRITICAL(&hcsr04_lock);
+        handle->armed = false;
+        handle->busy = false;
+        handle->callback = NULL;
+        portEXIT_CRITICAL(&hcsr04_lock);
+        return false;
+    }
+    return true;
+}
+
+typedef struct {
+    SemaphoreHandle_t done;
+    hcsr04_reading_t *reading;
+} hcsr04_waiter_t;
+
+static void hcsr04_measure_done(hcsr04_handle_t handle, const hcsr04_reading_t *reading, void *user_ctx)
+{
+    hcsr04_waiter_t *waiter = user_ctx;
+    *waiter->reading = *reading;
+    xSemaphoreGive(waiter->done);
+}
+
+bool hcsr04_measure(hcsr04_handle_t handle, const hcsr04_measure_options_t *options, hcsr04_reading_t *reading) {
+    if (reading == NULL) {
+        return false;
+    }
+
+    StaticSemaphore_t done_buffer;
+    hcsr04_waiter_t waiter = {
+        .done = xSemaphoreCreateBinaryStatic(&done_buffer),
+        .reading = reading,
+    };
+    if (!hcsr04_measure_async(handle, options, hcsr04_measure_done, &waiter)) {
+        *reading = (hcsr04_reading_t) {
+            .valid = false,
+            .error = HCSR04_ERROR_START,
+        };
+        return false;
+    }
+
+    // Always completes once the last ping window closes
+    xSemaphoreTake(waiter.done, portMAX_DELAY);
+    return reading->valid;
+}
+
+const char *hcsr04_error_to_name(hcsr04_error_t error) {
+    switch (error) {
+        case HCSR04_ERROR_NONE:
+            return "none";
+        case HCSR04_ERROR_START:
+            return "start";
+        case HCSR04_ERROR_NO_ECHO:
+            return "no echo";
+        case HCSR04_ERROR_UNSTABLE:
+            return "unstable";
+        default:
+            return "unknown";
+    }
+}
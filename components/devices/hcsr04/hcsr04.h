@@ -0,0 +1,70 @@
+/*
+ * HC-SR04 Ultrasonic Distance Sensor Driver
+ *
+ * Driver for HC-SR04 class ultrasonic rangers. The echo pulse is timed by
+ * an MCPWM capture channel and pings are paced by a one-shot timer, so a
+ * measurement costs a few interrupts and no busy-waiting beyond the 10 us
+ * trigger pulse. A measurement is the median of one or more pings.
+ */
+
+#ifndef HCSR04_H
+#define HCSR04_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hcsr04_echo.h"
+
+#define HCSR04_MAX_SENSORS 3                 // Capture channels on the shared capture timer
+#define HCSR04_MAX_PINGS 7
+#define HCSR04_DEFAULT_PINGS 1
+// Echo window per ping, which is also the trigger-to-trigger spacing. The datasheet's
+// minimum cycle is 60 ms; without a target the echo line stays high for ~38 ms.
+#define HCSR04_PING_INTERVAL_MS 60
+#define HCSR04_DEFAULT_MAX_DISTANCE_MM 4000
+#define HCSR04_DEFAULT_TEMPERATURE_CENTI_C 2000
+
+typedef enum {
+    HCSR04_ERROR_NONE,
+    HCSR04_ERROR_START,          // Trigger or timer could not be started
+    HCSR04_ERROR_NO_ECHO,        // No ping returned an echo within range
+    HCSR04_ERROR_UNSTABLE,       // Fewer than half of the pings returned an echo
+    HCSR04_ERROR_MAX,
+} hcsr04_error_t;
+
+typedef struct {
+    uint16_t distance_mm;
+    uint16_t echo_us;            // Median echo pulse
+    uint8_t echoes;              // Pings that returned an echo in range
+    bool valid;
+    hcsr04_error_t error;        // Failure when valid is false
+} hcsr04_reading_t;
+
+typedef struct {
+    int trigger_pin;
+    int echo_pin;
+    uint16_t max_distance_mm;    // Echoes from further away are ignored; 0 for the default
+} hcsr04_config_t;
+
+// Per-measurement options
+typedef struct {
+    uint8_t pings;                   // 1..HCSR04_MAX_PINGS; 0 for the default
+    int16_t temperature_centi_c;     // Air temperature for the speed of sound
+} hcsr04_measure_options_t;
+
+// Opaque sensor handle
+typedef struct hcsr04_dev_t *hcsr04_handle_t;
+
+// Completion callback for asynchronous measurements; runs in the esp_timer task
+typedef void (*hcsr04_measure_cb_t)(hcsr04_handle_t handle, const hcsr04_reading_t *reading, void *user_ctx);
+
+// HC-SR04 driver functions
+bool hcsr04_new(const hcsr04_config_t *config, hcsr04_handle_t *ret_handle);
+bool hcsr04_delete(hcsr04_handle_t handle);
+// Measurements accept NULL options for the default pings at 20 °C
+bool hcsr04_measure(hcsr04_handle_t handle, const hcsr04_measure_options_t *options, hcsr04_reading_t *reading);
+// Start a measurement and return immediately; false if one is already in progress on this handle
+bool hcsr04_measure_async(hcsr04_handle_t handle, const hcsr04_measure_options_t *options,
+                          hcsr04_measure_cb_t callback, void *user_ctx);
+const char *hcsr04_error_to_name(hcsr04_error_t error);
+
+#endif // HCSR04_H
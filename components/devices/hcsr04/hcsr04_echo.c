@@ -0,0 +1,41 @@
+/*
+ * HC-SR04 Echo Arithmetic Implementation
+ */
+
+#include "hcsr04_echo.h"
+
+// Speed of sound in air: 331.3 m/s at 0 °C, plus 0.606 m/s per °C
+#define HCSR04_SOUND_MM_S_AT_0C 331300
+#define HCSR04_SOUND_MM_S_PER_C 606
+
+uint32_t hcsr04_speed_of_sound_mm_s(int16_t temperature_centi_c) {
+    return (uint32_t)(HCSR04_SOUND_MM_S_AT_0C + (int32_t)temperature_centi_c * HCSR04_SOUND_MM_S_PER_C / 100);
+}
+
+uint32_t hcsr04_max_echo_us(uint16_t max_distance_mm, uint32_t sound_mm_s) {
+    return (uint32_t)((uint64_t)max_distance_mm * 2 * 1000000 / sound_mm_s);
+}
+
+uint16_t hcsr04_echo_median(uint16_t *echo_us, uint8_t count) {
+    if (count == 0) {
+        return 0;
+    }
+
+    // Insertion sort; a measurement has at most a handful of pings
+    for (uint8_t i = 1; i < count; i++) {
+        uint16_t value = echo_us[i];
+        uint8_t j = i;
+        while (j > 0 && echo_us[j - 1] > value) {
+            echo_us[j] = echo_us[j - 1];
+            j--;
+        }
+        echo_us[j] = value;
+    }
+    return echo_us[count / 2];
+}
+
+uint16_t hcsr04_echo_distance_mm(uint32_t echo_us, uint32_t sound_mm_s) {
+    // Round trip, so half the path
+    uint64_t distance_mm = (uint64_t)echo_us * sound_mm_s / (2 * 1000000);
+    return distance_mm > UINT16_MAX ? UINT16_MAX : (uint16_t)distance_mm;
+}
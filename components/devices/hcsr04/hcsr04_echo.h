@@ -0,0 +1,26 @@
+/*
+ * HC-SR04 Echo Arithmetic
+ *
+ * Pure conversions behind a measurement: speed of sound, echo window and
+ * the median echo of a set of pings as a distance. Has no hardware or
+ * ESP-IDF dependencies so it also builds on a host.
+ */
+
+#ifndef HCSR04_ECHO_H
+#define HCSR04_ECHO_H
+
+#include <stdint.h>
+
+// Speed of sound in mm/s at the given air temperature
+uint32_t hcsr04_speed_of_sound_mm_s(int16_t temperature_centi_c);
+
+// Longest echo pulse from a target at max_distance_mm
+uint32_t hcsr04_max_echo_us(uint16_t max_distance_mm, uint32_t sound_mm_s);
+
+// Sort count echo pulses in place and return the median (the upper one for even counts)
+uint16_t hcsr04_echo_median(uint16_t *echo_us, uint8_t count);
+
+// Distance of a round-trip echo in mm, saturating at UINT16_MAX
+uint16_t hcsr04_echo_distance_mm(uint32_t echo_us, uint32_t sound_mm_s);
+
+#endif // HCSR04_ECHO_H
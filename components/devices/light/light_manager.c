@@ -109,11 +109,8 @@ static esp_err_t light_manager_init(void)
     ESP_LOGI(TAG, "Initializing light manager");
 
     // Create mutex for thread safety
-    s_state_mutex = xSemaphoreCreateMutex();
-    if (s_state_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create state mutex");
-        return ESP_ERR_NO_MEM;
-    }
+    static StaticSemaphore_t state_mutex_buffer;
+    s_state_mutex = xSemaphoreCreateMutexStatic(&state_mutex_buffer);
 
     // Initialize hardware driver
     light_driver_init(s_current_state.power);
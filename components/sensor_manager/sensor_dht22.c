@@ -0,0 +1,110 @@
+/*
+ * DHT22 Sensor Driver Adapter Implementation
+ *
+ * Maps the DHT22 driver onto the sensor_driver_t operations
+ */
+
+#include "sensor_dht22.h"
+#include "dht22.h"
+#include "esp_log.h"
+
+static const char *TAG = "SENSOR_DHT22";
+
+// Retry transient DHT22 failures (2 s apart) instead of waiting a whole update interval
+#define DHT22_READ_ATTEMPTS 3
+#define DHT22_READ_TIMEOUT_MS 10000
+
+typedef struct {
+    int gpio_pin;
+    dht22_handle_t handle;
+    // Completion of the read in flight
+    sensor_driver_done_t done;
+    void *done_ctx;
+} sensor_dht22_t;
+
+static sensor_dht22_t dht22_instances[DHT22_MAX_SENSORS];
+static uint8_t dht22_instance_count = 0;
+
+static const dht22_read_options_t dht22_read_options = {
+    .max_attempts = DHT22_READ_ATTEMPTS,
+    .timeout_ms = DHT22_READ_TIMEOUT_MS,
+};
+
+static void dht22_to_reading(const dht22_reading_t *dht_reading, sensor_reading_t *reading)
+{
+    reading->valid = dht_reading->valid;
+    reading->data.env.temperature_centi_c = dht_reading->temperature_centi_c;
+    reading->data.env.humidity_centi_pct = dht_reading->humidity_centi_pct;
+}
+
+static bool sensor_dht22_init(void *ctx)
+{
+    sensor_dht22_t *sensor = ctx;
+    dht22_config_t config = {
+        .gpio_pin = sensor->gpio_pin,
+    };
+    return dht22_new(&config, &sensor->handle);
+}
+
+static bool sensor_dht22_read(void *ctx, sensor_reading_t *reading)
+{
+    sensor_dht22_t *sensor = ctx;
+    dht22_reading_t dht_reading;
+    dht22_read(sensor->handle, &dht22_read_options, &dht_reading);
+    dht22_to_reading(&dht_reading, reading);
+    if (!dht_reading.valid) {
+        ESP_LOGW(TAG, "GPIO %d: read failed: %s", sensor->gpio_pin, dht22_error_to_name(dht_reading.error));
+    }
+    return dht_reading.valid;
+}
+
+// Runs in the DHT22 driver task
+static void sensor_dht22_read_done(dht22_handle_t handle, const dht22_reading_t *dht_reading, void *user_ctx)
+{
+    sensor_dht22_t *sensor = user_ctx;
+    sensor_reading_t reading = { 0 };
+    dht22_to_reading(dht_reading, &reading);
+    if (!dht_reading->valid) {
+        ESP_LOGW(TAG, "GPIO %d: read failed: %s", sensor->gpio_pin, dht22_error_to_name(dht_reading->error));
+    }
+    sensor->done(sensor->done_ctx, &reading);
+}
+
+static bool sensor_dht22_read_async(void *ctx, sensor_driver_done_t done, void *done_ctx)
+{
+    sensor_dht22_t *sensor = ctx;
+    sensor->done = done;
+    sensor->done_ctx = done_ctx;
+    return dht22_read_async(sensor->handle, &dht22_read_options, sensor_dht22_read_done, sensor);
+}
+
+static bool sensor_dht22_is_available(void *ctx)
+{
+    sensor_dht22_t *sensor = ctx;
+    return dht22_is_available(sensor->handle);
+}
+
+static const sensor_driver_t sensor_dht22_driver = {
+    .name = "DHT22",
+    .type = SENSOR_TYPE_ENVIRONMENTAL,
+    .init = sensor_dht22_init,
+    .read = sensor_dht22_read,
+    .read_async = sensor_dht22_read_async,
+    .is_available = sensor_dht22_is_available,
+};
+
+bool sensor_dht22_register(int gpio_pin, sensor_id_t *ret_id)
+{
+    if (dht22_instance_count >= DHT22_MAX_SENSORS) {
+        ESP_LOGE(TAG, "Maximum number of DHT22 sensors reached (%d)", DHT22_MAX_SENSORS);
+        return false;
+    }
+
+    sensor_dht22_t *sensor = &dht22_instances[dht22_instance_count];
+    sensor->gpio_pin = gpio_pin;
+    if (!sensor_register(&sensor_dht22_driver, sensor, ret_id)) {
+        return false;
+    }
+    dht22_instance_count++;
+    return true;
+}
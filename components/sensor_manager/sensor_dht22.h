@@ -0,0 +1,15 @@
+/*
+ * DHT22 Sensor Driver Adapter
+ *
+ * Registers DHT22 sensors with the sensor interface
+ */
+
+#ifndef SENSOR_DHT22_H
+#define SENSOR_DHT22_H
+
+#include <stdbool.h>
+#include "sensor_interface.h"
+
+bool sensor_dht22_register(int gpio_pin, sensor_id_t *ret_id);
+
+#endif // SENSOR_DHT22_H
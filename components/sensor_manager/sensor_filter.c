@@ -0,0 +1,132 @@
+/*
+ * Sensor Filter Pipeline Implementation
+ */
+
+#include <string.h>
+#include "sensor_filter.h"
+
+// The EMA step truncates below 1 / 2^shift of the accumulator's resolution,
+// so the fraction must exceed the largest shift for the average to settle on
+// its input. 8 bits of headroom keep the residual under 1/256 of a unit.
+#define EMA_MAX_SHIFT 16
+#define EMA_FRACTION_BITS (EMA_MAX_SHIFT + 8)
+
+static int32_t clamp_i32(int64_t value)
+{
+    if (value > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (value < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)value;
+}
+
+static int32_t median_of(const int32_t *samples, uint8_t count)
+{
+    int32_t sorted[SENSOR_FILTER_MEDIAN_MAX];
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t value = samples[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    return sorted[count / 2];
+}
+
+bool sensor_filter_init(sensor_filter_t *filter, const sensor_filter_config_t *config)
+{
+    if (config->num_stages > SENSOR_FILTER_MAX_STAGES) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < config->num_stages; i++) {
+        const sensor_filter_stage_t *stage = &config->stages[i];
+        switch (stage->type) {
+            case SENSOR_FILTER_CALIBRATE:
+                break;
+            case SENSOR_FILTER_MEDIAN:
+                if (stage->median.window == 0 || stage->median.window > SENSOR_FILTER_MEDIAN_MAX) {
+                    return false;
+                }
+                break;
+            case SENSOR_FILTER_EMA:
+                if (stage->ema.shift > EMA_MAX_SHIFT) {
+                    return false;
+                }
+                break;
+            case SENSOR_FILTER_RATE_LIMIT:
+                if (stage->rate.max_per_s <= 0) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    memset(filter, 0, sizeof(*filter));
+    filter->config = *config;
+    return true;
+}
+
+bool sensor_filter_apply(sensor_filter_t *filter, int64_t now_us, int32_t *value)
+{
+    int32_t x = *value;
+
+    for (uint8_t i = 0; i < filter->config.num_stages; i++) {
+        const sensor_filter_stage_t *stage = &filter->config.stages[i];
+        sensor_filter_state_t *state = &filter->state[i];
+
+        switch (stage->type) {
+            case SENSOR_FILTER_CALIBRATE:
+                x = clamp_i32((int64_t)x * stage->calibrate.scale_q16 / SENSOR_FILTER_SCALE_ONE +
+                              stage->calibrate.offset);
+                break;
+
+            case SENSOR_FILTER_MEDIAN:
+                state->samples[state->next] = x;
+                state->next = (state->next + 1) % stage->median.window;
+                if (state->count < stage->median.window) {
+                    state->count++;
+                }
+                x = median_of(state->samples, state->count);
+                break;
+
+            case SENSOR_FILTER_EMA: {
+                int64_t sample = (int64_t)x * (1LL << EMA_FRACTION_BITS);
+                if (!state->primed) {
+                    state->acc = sample;
+                    state->primed = true;
+                } else {
+                    state->acc += (sample - state->acc) / (1 << stage->ema.shift);
+                }
+                x = clamp_i32((state->acc + (1LL << (EMA_FRACTION_BITS - 1))) >> EMA_FRACTION_BITS);
+                break;
+            }
+
+            case SENSOR_FILTER_RATE_LIMIT:
+                if (state->primed) {
+                    int64_t elapsed_us = now_us - state->last_us;
+                    int64_t allowed = (int64_t)stage->rate.max_per_s * elapsed_us / 1000000;
+                    int64_t change = (int64_t)x - state->last;
+                    if ((change > allowed || -change > allowed) &&
+                        state->rejects < stage->rate.max_rejects) {
+                        state->rejects++;
+                        return false;
+                    }
+                }
+                state->primed = true;
+                state->rejects = 0;
+                state->last = x;
+                state->last_us = now_us;
+                break;
+        }
+    }
+
+    *value = x;
+    return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * Sensor Filter Pipeline
+ *
+ * Integer filter chain for one scalar channel. Stages run in the configured
+ * order; each keeps its own state in the sensor_filter_t, so no allocation
+ * happens at runtime. Has no ESP-IDF dependencies.
+ */
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SENSOR_FILTER_MAX_STAGES 4
+#define SENSOR_FILTER_MEDIAN_MAX 7
+#define SENSOR_FILTER_SCALE_ONE 65536    // Unity gain for SENSOR_FILTER_CALIBRATE (Q16)
+
+typedef enum {
+    SENSOR_FILTER_CALIBRATE,     // value * scale_q16 / 65536 + offset
+    SENSOR_FILTER_MEDIAN,        // Median of the last window samples (spike rejection)
+    SENSOR_FILTER_EMA,           // Exponential moving average with alpha = 1 / 2^shift
+    SENSOR_FILTER_RATE_LIMIT,    // Reject samples changing faster than max_per_s
+} sensor_filter_type_t;
+
+typedef struct {
+    sensor_filter_type_t type;
+    union {
+        struct {
+            int32_t offset;
+            int32_t scale_q16;
+        } calibrate;
+        struct {
+            uint8_t window;      // 1..SENSOR_FILTER_MEDIAN_MAX
+        } median;
+        struct {
+            uint8_t shift;       // 0 passes samples through
+        } ema;
+        struct {
+            int32_t max_per_s;   // Largest plausible change per second, in channel units
+            uint8_t max_rejects; // Accept a new level after this many consecutive rejects
+        } rate;
+    };
+} sensor_filter_stage_t;
+
+typedef struct {
+    sensor_filter_stage_t stages[SENSOR_FILTER_MAX_STAGES];
+    uint8_t num_stages;
+} sensor_filter_config_t;
+
+// Per-stage state; each stage type uses only its own fields
+typedef struct {
+    int32_t samples[SENSOR_FILTER_MEDIAN_MAX];
+    uint8_t count;
+    uint8_t next;
+    bool primed;
+    int64_t acc;                 // EMA accumulator, Q24
+    int32_t last;                // Last accepted value (rate limit)
+    int64_t last_us;
+    uint8_t rejects;
+} sensor_filter_state_t;
+
+typedef struct {
+    sensor_filter_config_t config;
+    sensor_filter_state_t state[SENSOR_FILTER_MAX_STAGES];
+} sensor_filter_t;
+
+// False if the configuration is invalid
+bool sensor_filter_init(sensor_filter_t *filter, const sensor_filter_config_t *config);
+// Run a sample through the chain; returns false (value untouched) if a stage rejected it
+bool sensor_filter_apply(sensor_filter_t *filter, int64_t now_us, int32_t *value);
+
+#endif // SENSOR_FILTER_H
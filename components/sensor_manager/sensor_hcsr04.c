@@ -0,0 +1,125 @@
+/*
+ * HC-SR04 Sensor Driver Adapter Implementation
+ *
+ * Maps the HC-SR04 driver onto the sensor_driver_t operations. The speed of
+ * sound is compensated with the latest environmental reading held by the
+ * sensor manager.
+ */
+
+#include "sensor_hcsr04.h"
+#include "sensor_manager.h"
+#include "hcsr04.h"
+#include "esp_log.h"
+#include "timing.h"
+
+static const char *TAG = "SENSOR_HCSR04";
+
+// One 60 ms ping per read leaves room for 10 Hz sampling; spikes are removed by
+// a median filter across reads in the sensor manager instead
+#define HCSR04_READ_PINGS 1
+// Older temperatures fall back to the driver default (20 °C); ~0.17 % of range per °C
+#define HCSR04_TEMPERATURE_MAX_AGE_US (15LL * 60 * 1000000)
+
+typedef struct {
+    int trigger_pin;
+    int echo_pin;
+    hcsr04_handle_t handle;
+    // Completion of the read in flight
+    sensor_driver_done_t done;
+    void *done_ctx;
+} sensor_hcsr04_t;
+
+static sensor_hcsr04_t hcsr04_instances[HCSR04_MAX_SENSORS];
+static uint8_t hcsr04_instance_count = 0;
+
+static void hcsr04_read_options(hcsr04_measure_options_t *options)
+{
+    options->pings = HCSR04_READ_PINGS;
+    options->temperature_centi_c = HCSR04_DEFAULT_TEMPERATURE_CENTI_C;
+
+    sensor_id_t env = sensor_find(SENSOR_TYPE_ENVIRONMENTAL);
+    sensor_reading_t reading;
+    if (env != SENSOR_ID_INVALID && sensor_manager_get_latest_reading(env, &reading) &&
+        timing_monotonic_us() - reading.sampled_at_us < HCSR04_TEMPERATURE_MAX_AGE_US) {
+        options->temperature_centi_c = reading.data.env.temperature_centi_c;
+    }
+}
+
+static void hcsr04_to_reading(const hcsr04_reading_t *hcsr04_reading, sensor_reading_t *reading)
+{
+    reading->valid = hcsr04_reading->valid;
+    reading->data.distance_mm = hcsr04_reading->distance_mm;
+}
+
+static bool sensor_hcsr04_init(void *ctx)
+{
+    sensor_hcsr04_t *sensor = ctx;
+    hcsr04_config_t config = {
+        .trigger_pin = sensor->trigger_pin,
+        .echo_pin = sensor->echo_pin,
+    };
+    return hcsr04_new(&config, &sensor->handle);
+}
+
+static bool sensor_hcsr04_read(void *ctx, sensor_reading_t *reading)
+{
+    sensor_hcsr04_t *sensor = ctx;
+    hcsr04_measure_options_t options;
+    hcsr04_reading_t hcsr04_reading;
+    hcsr04_read_options(&options);
+    hcsr04_measure(sensor->handle, &options, &hcsr04_reading);
+    hcsr04_to_reading(&hcsr04_reading, reading);
+    if (!hcsr04_reading.valid) {
+        ESP_LOGD(TAG, "Echo GPIO %d: read failed: %s", sensor->echo_pin,
+                 hcsr04_error_to_name(hcsr04_reading.error));
+    }
+    return hcsr04_reading.valid;
+}
+
+// Runs in the esp_timer task
+static void sensor_hcsr04_read_done(hcsr04_handle_t handle, const hcsr04_reading_t *hcsr04_reading, void *user_ctx)
+{
+    sensor_hcsr04_t *sensor = user_ctx;
+    sensor_reading_t reading = { 0 };
+    hcsr04_to_reading(hcsr04_reading, &reading);
+    if (!hcsr04_reading->valid) {
+        ESP_LOGD(TAG, "Echo GPIO %d: read failed: %s", sensor->echo_pin,
+                 hcsr04_error_to_name(hcsr04_reading->error));
+    }
+    sensor->done(sensor->done_ctx, &reading);
+}
+
+static bool sensor_hcsr04_read_async(void *ctx, sensor_driver_done_t done, void *done_ctx)
+{
+    sensor_hcsr04_t *sensor = ctx;
+    hcsr04_measure_options_t options;
+    hcsr04_read_options(&options);
+    sensor->done = done;
+    sensor->done_ctx = done_ctx;
+    return hcsr04_measure_async(sensor->handle, &options, sensor_hcsr04_read_done, sensor);
+}
+
+static const sensor_driver_t sensor_hcsr04_driver = {
+    .name = "HC-SR04",
+    .type = SENSOR_TYPE_DEPTH,
+    .init = sensor_hcsr04_init,
+    .read = sensor_hcsr04_read,
+    .read_async = sensor_hcsr04_read_async,
+};
+
+bool sensor_hcsr04_register(int trigger_pin, int echo_pin, sensor_id_t *ret_id)
+{
+    if (hcsr04_instance_count >= HCSR04_MAX_SENSORS) {
+        ESP_LOGE(TAG, "Maximum number of HC-SR04 sensors reached (%d)", HCSR04_MAX_SENSORS);
+        return false;
+    }
+
+    sensor_hcsr04_t *sensor = &hcsr04_instances[hcsr04_instance_count];
+    sensor->trigger_pin = trigger_pin;
+    sensor->echo_pin = echo_pin;
+    if (!sensor_register(&sensor_hcsr04_driver, sensor, ret_id)) {
+        return false;
+    }
+    hcsr04_instance_count++;
+    return true;
+}
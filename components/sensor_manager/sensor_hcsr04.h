@@ -0,0 +1,15 @@
+/*
+ * HC-SR04 Sensor Driver Adapter
+ *
+ * Registers HC-SR04 ultrasonic rangers with the sensor interface as depth sensors
+ */
+
+#ifndef SENSOR_HCSR04_H
+#define SENSOR_HCSR04_H
+
+#include <stdbool.h>
+#include "sensor_interface.h"
+
+bool sensor_hcsr04_register(int trigger_pin, int echo_pin, sensor_id_t *ret_id);
+
+#endif // SENSOR_HCSR04_H
@@ -1,75 +1,194 @@
 /*
  * Sensor Interface Implementation
  *
- * Generic interface implementation for all sensor types
+ * Sensor driver registry and board sensor setup
  */
 
 #include "sensor_interface.h"
-#include "dht22.h"
+#include "sensor_dht22.h"
+#include "sensor_hcsr04.h"
 #include "esp_log.h"
-#include "esp_timer.h"
+#include "app_config.h"
+#include "timing.h"
 
 static const char *TAG = "SENSOR_INTERFACE";
 
 // DHT22 sensor GPIO pin configuration
 #define DHT22_GPIO_PIN 0
 
+// A registered sensor instance. Entries are only added, so lookups by id need no lock.
+typedef struct {
+    const sensor_driver_t *driver;
+    void *ctx;
+    // Asynchronous read in flight, one per instance
+    sensor_read_done_t done;
+    void *done_ctx;
+} sensor_entry_t;
+
+static sensor_entry_t sensors[SENSOR_MAX_INSTANCES];
+static uint8_t sensor_entry_count = 0;
+
+static inline sensor_entry_t *sensor_entry(sensor_id_t id)
+{
+    return id < sensor_entry_count ? &sensors[id] : NULL;
+}
+
+static void sensor_stamp(sensor_id_t id, sensor_reading_t *reading)
+{
+    reading->id = id;
+    reading->type = sensors[id].driver->type;
+    reading->sampled_at_us = timing_monotonic_us();
+    reading->published_at_us = 0;
+}
+
 bool sensor_init(void)
 {
     ESP_LOGI(TAG, "Initializing sensor interface");
 
     // Initialize DHT22 sensor on GPIO0
-    if (!dht22_init(DHT22_GPIO_PIN)) {
+    sensor_id_t id;
+    if (!sensor_dht22_register(DHT22_GPIO_PIN, &id)) {
         ESP_LOGE(TAG, "Failed to initialize DHT22 sensor");
         return false;
     }
 
+#if APP_HCSR04_ENABLED
+    // Door position is optional; the environmental sensor works without it
+    if (!sensor_hcsr04_register(APP_HCSR04_TRIGGER_GPIO, APP_HCSR04_ECHO_GPIO, &id)) {
+        ESP_LOGW(TAG, "Failed to initialize HC-SR04 sensor");
+    }
+#endif
+
     ESP_LOGI(TAG, "Sensor interface initialized successfully");
     return true;
 }
 
-bool sensor_read(sensor_type_t type, sensor_reading_t *reading)
+bool sensor_register(const sensor_driver_t *driver, void *ctx, sensor_id_t *ret_id)
 {
-    if (!reading) {
+    if (driver == NULL || driver->read == NULL || ret_id == NULL) {
         return false;
     }
 
-    reading->type = type;
-    reading->timestamp = esp_timer_get_time() / 1000; // milliseconds
-    reading->valid = false;
+    if (sensor_entry_count >= SENSOR_MAX_INSTANCES) {
+        ESP_LOGE(TAG, "Maximum number of sensors reached (%d)", SENSOR_MAX_INSTANCES);
+        return false;
+    }
+
+    if (driver->init && !driver->init(ctx)) {
+        ESP_LOGE(TAG, "Failed to initialize %s sensor", driver->name);
+        return false;
+    }
+
+    sensor_id_t id = sensor_entry_count;
+    sensors[id] = (sensor_entry_t) {
+        .driver = driver,
+        .ctx = ctx,
+    };
+    sensor_entry_count++;
 
-    switch (type) {
-        case SENSOR_TYPE_ENVIRONMENTAL: {
-            dht22_reading_t dht_reading;
-            if (dht22_read(&dht_reading)) {
-                reading->data.env.temperature_c = dht_reading.temperature_c;
-                reading->data.env.humidity_percent = dht_reading.humidity_percent;
-                reading->valid = true;
-                ESP_LOGD(TAG, "Environmental sensor reading: T=%.1f°C, H=%.1f%%",
-                        reading->data.env.temperature_c, reading->data.env.humidity_percent);
-                return true;
-            } else {
-                ESP_LOGW(TAG, "Failed to read DHT22 sensor");
-                return false;
-            }
+    ESP_LOGI(TAG, "Registered %s sensor as id %d", driver->name, id);
+    *ret_id = id;
+    return true;
+}
+
+size_t sensor_count(void)
+{
+    return sensor_entry_count;
+}
+
+sensor_id_t sensor_find(sensor_type_t type)
+{
+    for (sensor_id_t id = 0; id < sensor_entry_count; id++) {
+        if (sensors[id].driver->type == type) {
+            return id;
         }
-        case SENSOR_TYPE_DEPTH:
-        case SENSOR_TYPE_VEHICLE_PRESENCE:
-        default:
-            ESP_LOGW(TAG, "Sensor reading not implemented for type %d", type);
-            return false;
     }
+    return SENSOR_ID_INVALID;
+}
+
+bool sensor_get_type(sensor_id_t id, sensor_type_t *type)
+{
+    sensor_entry_t *entry = sensor_entry(id);
+    if (entry == NULL || type == NULL) {
+        return false;
+    }
+
+    *type = entry->driver->type;
+    return true;
+}
+
+const char *sensor_get_name(sensor_id_t id)
+{
+    sensor_entry_t *entry = sensor_entry(id);
+    return entry ? entry->driver->name : "unknown";
+}
+
+bool sensor_read(sensor_id_t id, sensor_reading_t *reading)
+{
+    sensor_entry_t *entry = sensor_entry(id);
+    if (entry == NULL || reading == NULL) {
+        return false;
+    }
+
+    sensor_stamp(id, reading);
+    reading->valid = false;
+
+    if (!entry->driver->read(entry->ctx, reading)) {
+        ESP_LOGW(TAG, "Failed to read %s sensor %d", entry->driver->name, id);
+        reading->valid = false;
+        return false;
+    }
+    return reading->valid;
+}
+
+static void sensor_async_done(void *done_ctx, const sensor_reading_t *driver_reading)
+{
+    sensor_entry_t *entry = done_ctx;
+    sensor_id_t id = (sensor_id_t)(entry - sensors);
+
+    sensor_reading_t reading = *driver_reading;
+    sensor_stamp(id, &reading);
+
+    sensor_read_done_t done = entry->done;
+    void *user_ctx = entry->done_ctx;
+    entry->done = NULL;
+    done(id, &reading, user_ctx);
 }
 
-bool sensor_is_available(sensor_type_t type)
+bool sensor_read_async(sensor_id_t id, sensor_read_done_t done, void *user_ctx)
 {
-    switch (type) {
-        case SENSOR_TYPE_ENVIRONMENTAL:
-            return dht22_is_available();
-        case SENSOR_TYPE_DEPTH:
-        case SENSOR_TYPE_VEHICLE_PRESENCE:
-        default:
-            ESP_LOGW(TAG, "Sensor availability check not implemented for type %d", type);
-            return false;
+    sensor_entry_t *entry = sensor_entry(id);
+    if (entry == NULL || done == NULL) {
+        return false;
     }
-}
\ No newline at end of file
+
+    if (entry->driver->read_async == NULL) {
+        sensor_reading_t reading;
+        sensor_read(id, &reading);
+        done(id, &reading, user_ctx);
+        return true;
+    }
+
+    if (entry->done != NULL) {
+        ESP_LOGD(TAG, "Read already in progress on %s sensor %d", entry->driver->name, id);
+        return false;
+    }
+
+    entry->done = done;
+    entry->done_ctx = user_ctx;
+    if (!entry->driver->read_async(entry->ctx, sensor_async_done, entry)) {
+        entry->done = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool sensor_is_available(sensor_id_t id)
+{
+    sensor_entry_t *entry = sensor_entry(id);
+    if (entry == NULL) {
+        return false;
+    }
+
+    return entry->driver->is_available ? entry->driver->is_available(entry->ctx) : true;
+}
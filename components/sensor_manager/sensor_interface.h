@@ -1,15 +1,21 @@
 /*
  * Sensor Interface Header
  *
- * Generic interface for all sensor types in the garage controller
+ * Generic interface for all sensor types in the garage controller.
+ * Each sensor instance is a registered driver (ops table + context) and is
+ * addressed by the sensor id returned at registration.
  */
 
 #ifndef SENSOR_INTERFACE_H
 #define SENSOR_INTERFACE_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 
+#define SENSOR_MAX_INSTANCES 8
+#define SENSOR_ID_INVALID 0xFF
+
 // Sensor types
 typedef enum {
     SENSOR_TYPE_DEPTH,
@@ -17,24 +23,55 @@ typedef enum {
     SENSOR_TYPE_VEHICLE_PRESENCE
 } sensor_type_t;
 
+// Index into the sensor registry, assigned by sensor_register()
+typedef uint8_t sensor_id_t;
+
 // Generic sensor data structure
 typedef struct {
+    sensor_id_t id;
     sensor_type_t type;
-    uint32_t timestamp;
+    int64_t sampled_at_us;       // Monotonic time the sensor was read (timing_monotonic_us)
+    int64_t published_at_us;     // Monotonic time handed to subscribers; 0 if not published
     bool valid;
     union {
-        float distance_mm;        // For depth sensors
-        struct {                 // For environmental sensors
-            float temperature_c;
-            float humidity_percent;
+        uint16_t distance_mm;    // For depth sensors
+        struct {                 // For environmental sensors (fixed-point, matches ZCL units)
+            int16_t temperature_centi_c;     // 0.01 °C
+            uint16_t humidity_centi_pct;     // 0.01 %RH
         } env;
         bool vehicle_present;    // For vehicle presence
     } data;
 } sensor_reading_t;
 
+// Completion of an asynchronous read; reading->valid is false on failure
+typedef void (*sensor_read_done_t)(sensor_id_t id, const sensor_reading_t *reading, void *user_ctx);
+
+// Driver-side completion, handed to sensor_driver_t.read_async
+typedef void (*sensor_driver_done_t)(void *done_ctx, const sensor_reading_t *reading);
+
+// Driver operations. ctx is the instance context given to sensor_register().
+// Drivers only fill reading->valid and reading->data; the interface sets id, type and sampled_at_us.
+typedef struct {
+    const char *name;
+    sensor_type_t type;
+    bool (*init)(void *ctx);                                      // Optional
+    bool (*read)(void *ctx, sensor_reading_t *reading);
+    // Optional; start a read and return immediately, calling done exactly once if it returns true
+    bool (*read_async)(void *ctx, sensor_driver_done_t done, void *done_ctx);
+    bool (*is_available)(void *ctx);                              // Optional
+} sensor_driver_t;
+
 // Sensor interface functions
 bool sensor_init(void);
-bool sensor_read(sensor_type_t type, sensor_reading_t *reading);
-bool sensor_is_available(sensor_type_t type);
+bool sensor_register(const sensor_driver_t *driver, void *ctx, sensor_id_t *ret_id);
+size_t sensor_count(void);
+// First registered sensor of a type, or SENSOR_ID_INVALID
+sensor_id_t sensor_find(sensor_type_t type);
+bool sensor_get_type(sensor_id_t id, sensor_type_t *type);
+const char *sensor_get_name(sensor_id_t id);
+bool sensor_read(sensor_id_t id, sensor_reading_t *reading);
+// Falls back to a synchronous read (done called before returning) for drivers without read_async
+bool sensor_read_async(sensor_id_t id, sensor_read_done_t done, void *user_ctx);
+bool sensor_is_available(sensor_id_t id);
 
-#endif // SENSOR_INTERFACE_H
\ No newline at end of file
+#endif // SENSOR_INTERFACE_H
@@ -1,57 +1,979 @@
 /*
  * Sensor Manager Implementation
  *
- * Handles periodic sensor readings and manages callbacks for sensor updates
+ * Handles periodic sensor readings and dispatches sensor updates to subscribers
  */
 
 #include "sensor_manager.h"
+#include "sensor_window.h"
+#include "sensor_filter.h"
+#include "sensor_snapshot.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "app_resources.h"
+#include "timing.h"
 
 static const char *TAG = "SENSOR_MANAGER";
 
-#define MAX_CALLBACKS 4
-#define SENSOR_UPDATE_TASK_STACK_SIZE 4096
-#define SENSOR_UPDATE_TASK_PRIORITY 5
+#define SENSOR_MANAGER_MAX_SUBSCRIBERS APP_SENSOR_SUBSCRIBERS
+#define SENSOR_SUBSCRIBER_DEFAULT_DEPTH 4
+#define SENSOR_STARTUP_DELAY_MS 5000    // Phase of the default schedule
+#define SENSOR_STOP_TIMEOUT_MS 15000    // Longest wait for reads in flight when stopping
+
+// An on-demand request can be queued per sensor; completions have their own slots
+_Static_assert(APP_SENSOR_EVENT_QUEUE_LEN >= SENSOR_MAX_INSTANCES, "Sensor event queue too short");
+
+// Task notification bits for the update task
+#define SENSOR_NOTIFY_EVENT (1 << 0)          // Event queued
+#define SENSOR_NOTIFY_RECONFIGURE (1 << 1)    // Schedules changed
+#define SENSOR_NOTIFY_STOP (1 << 2)           // Stop at the next safe point
+#define SENSOR_NOTIFY_START (1 << 3)          // Leave the stopped state
+#define SENSOR_NOTIFY_READ_DONE (1 << 4)      // Read completion handed over
+
+// A sensor polled every period_ms, first phase_ms after updates start
+typedef struct {
+    sensor_id_t id;
+    uint32_t period_ms;          // Effective period, adjusted by adaptive sampling
+    uint32_t base_period_ms;     // Period given to sensor_manager_schedule()
+    uint32_t phase_ms;
+    int64_t next_due_us;
+} sensor_schedule_t;
 
 // Static variables
-static sensor_update_callback_t callbacks[MAX_CALLBACKS];
-static uint8_t callback_count = 0;
+
+/*
+ * Subscribers
+ *
+ * Each subscriber has a bounded ring of readings and its own dispatch task,
+ * so a slow consumer (e.g. one waiting on the Zigbee lock) only backs up
+ * its own queue. The sensor task never blocks on a subscriber: when a ring
+ * is full the oldest reading is dropped, and with SENSOR_QUEUE_COALESCE a
+ * newer reading replaces a queued one from the same sensor.
+ */
+typedef struct {
+    sensor_subscriber_config_t config;
+    TaskHandle_t task;
+    StaticTask_t task_buffer;
+    StackType_t task_stack[APP_SENSOR_SUBSCRIBER_TASK_STACK_SIZE];
+    sensor_reading_t ring[SENSOR_SUBSCRIBER_QUEUE_MAX];
+    uint8_t head;
+    uint8_t len;
+    sensor_subscriber_stats_t stats;
+} sensor_subscriber_t;
+
+static sensor_subscriber_t subscribers[SENSOR_MANAGER_MAX_SUBSCRIBERS];
+static uint8_t subscriber_count = 0;
+static portMUX_TYPE subscriber_lock = portMUX_INITIALIZER_UNLOCKED;
+// The update task is created once and parks while updates are stopped
 static TaskHandle_t sensor_update_task_handle = NULL;
-static uint32_t update_interval_ms = 0;
-static sensor_reading_t latest_readings[SENSOR_TYPE_VEHICLE_PRESENCE + 1];
+static StaticTask_t sensor_update_task_buffer;
+static StackType_t sensor_update_task_stack[APP_SENSOR_TASK_STACK_SIZE];
+static volatile sensor_manager_state_t manager_state = SENSOR_MANAGER_STOPPED;
+static SemaphoreHandle_t stopped_semaphore = NULL;
+static StaticSemaphore_t stopped_semaphore_buffer;
 
-static void sensor_update_task(void *pvParameters)
+// Update task counters, guarded by schedule_lock
+static uint32_t reads_started = 0;
+static uint32_t deadlines_skipped = 0;
+static uint32_t reconfigurations = 0;
+static uint32_t readings_completed = 0;
+static uint32_t read_failures = 0;
+static uint32_t filter_rejects = 0;
+static uint32_t readings_published = 0;
+static uint8_t event_queue_max_depth = 0;
+static uint32_t report_readings = 0;     // Readings at the previous sensor_manager_report()
+static int64_t report_at_us = 0;
+
+// Latest reading per sensor, written only by the update task
+static sensor_snapshot_t latest_readings[SENSOR_MAX_INSTANCES];
+
+// Events processed by the sensor update task
+typedef enum {
+    SENSOR_EVENT_READ_REQUEST,  // On-demand read of reading.id
+} sensor_event_type_t;
+
+typedef struct {
+    sensor_event_type_t type;
+    sensor_reading_t reading;
+} sensor_event_t;
+
+// Windowed history of one channel of one sensor, guarded by history_lock
+typedef struct {
+    bool in_use;
+    sensor_id_t id;
+    sensor_channel_t channel;
+    sensor_window_t windows[SENSOR_HISTORY_SPAN_MAX];
+    bool logged;                 // Also appended to the on-flash log
+    int64_t logged_at_us;
+} sensor_series_t;
+
+static const uint32_t history_span_s[SENSOR_HISTORY_SPAN_MAX] = {
+    [SENSOR_HISTORY_15_MIN] = 15 * 60,
+    [SENSOR_HISTORY_1_HOUR] = 60 * 60,
+    [SENSOR_HISTORY_24_HOURS] = 24 * 60 * 60,
+};
+
+static sensor_series_t history_series[SENSOR_HISTORY_MAX_SERIES];
+static portMUX_TYPE history_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Filter chain on one channel of one sensor, guarded by filter_lock
+typedef struct {
+    bool in_use;
+    sensor_id_t id;
+    sensor_channel_t channel;
+    bool has_output;
+    int32_t output;              // Last filtered value, held while samples are rejected
+    sensor_filter_t filter;
+} sensor_filter_chain_t;
+
+static sensor_filter_chain_t filter_chains[SENSOR_FILTER_MAX_CHAINS];
+static portMUX_TYPE filter_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Report-on-change state per sensor; config is guarded by publish_lock,
+// the rest is owned by the update task
+typedef struct {
+    sensor_publish_config_t config;
+    bool published;
+    int64_t published_us;
+    sensor_reading_t last;
+    bool held;                   // A change arrived within min_interval_ms of the last publish
+    sensor_reading_t held_reading;
+} sensor_publish_t;
+
+static sensor_publish_t publish_state[SENSOR_MAX_INSTANCES];
+static portMUX_TYPE publish_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Sample-to-publish latency per sensor, guarded by publish_lock
+static sensor_latency_t publish_latency[SENSOR_MAX_INSTANCES];
+
+static QueueHandle_t sensor_event_queue = NULL;
+static StaticQueue_t sensor_event_queue_buffer;
+static uint8_t sensor_event_queue_storage[APP_SENSOR_EVENT_QUEUE_LEN * sizeof(sensor_event_t)];
+
+// Callers of sensor_manager_request_read() waiting for a read, guarded by waiter_lock.
+// Waiters live on the callers' stacks; every waiter of a sensor shares its next read.
+typedef struct sensor_waiter {
+    struct sensor_waiter *next;
+    sensor_id_t id;
+    SemaphoreHandle_t done;
+    StaticSemaphore_t done_buffer;
+    sensor_reading_t reading;
+} sensor_waiter_t;
+
+static sensor_waiter_t *waiters = NULL;
+static portMUX_TYPE waiter_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool read_in_flight[SENSOR_MAX_INSTANCES];   // Owned by the update task
+
+// Asynchronous read results waiting for the update task, guarded by completion_lock.
+// Drivers complete from shared contexts such as the esp_timer task, so handing over
+// must never block; a sensor has at most one read in flight, so its slot is free.
+typedef struct {
+    bool pending;
+    sensor_reading_t reading;
+} sensor_completion_t;
+
+static sensor_completion_t completions[SENSOR_MAX_INSTANCES];
+static portMUX_TYPE completion_lock = portMUX_INITIALIZER_UNLOCKED;
+// Consecutive failed reads per sensor, owned by the update task. Failures are logged
+// when a sensor starts and stops failing, not on every read.
+static uint32_t read_failure_streak[SENSOR_MAX_INSTANCES];
+
+// Schedules form a binary min-heap on next_due_us, guarded by schedule_lock
+static sensor_schedule_t schedules[SENSOR_MANAGER_MAX_SCHEDULES];
+static uint8_t schedule_count = 0;
+static portMUX_TYPE schedule_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Adaptive sampling state per sensor, guarded by schedule_lock
+typedef struct {
+    bool enabled;
+    bool primed;
+    sensor_adaptive_config_t config;
+    int32_t last[SENSOR_CHANNEL_MAX];
+    int32_t activity[SENSOR_CHANNEL_MAX];    // Moving average of the change per sample
+} sensor_adaptive_t;
+
+static sensor_adaptive_t adaptive_state[SENSOR_MAX_INSTANCES];
+
+static void schedule_swap(uint8_t a, uint8_t b)
 {
-    ESP_LOGI(TAG, "Starting sensor update task");
+    sensor_schedule_t tmp = schedules[a];
+    schedules[a] = schedules[b];
+    schedules[b] = tmp;
+}
 
-    // Initial sensor reading after startup delay
-    vTaskDelay(pdMS_TO_TICKS(5000));  // Wait 5 seconds after startup
+static void schedule_sift_up(uint8_t pos)
+{
+    while (pos > 0) {
+        uint8_t parent = (pos - 1) / 2;
+        if (schedules[parent].next_due_us <= schedules[pos].next_due_us) {
+            break;
+        }
+        schedule_swap(parent, pos);
+        pos = parent;
+    }
+}
 
+static void schedule_sift_down(uint8_t pos)
+{
     while (true) {
-        // Read environmental sensor
+        uint8_t smallest = pos;
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        if (left < schedule_count && schedules[left].next_due_us < schedules[smallest].next_due_us) {
+            smallest = left;
+        }
+        if (right < schedule_count && schedules[right].next_due_us < schedules[smallest].next_due_us) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        schedule_swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+static void schedule_remove_at(uint8_t pos)
+{
+    schedule_count--;
+    if (pos == schedule_count) {
+        return;
+    }
+    schedules[pos] = schedules[schedule_count];
+    schedule_sift_down(pos);
+    schedule_sift_up(pos);
+}
+
+static int schedule_find(sensor_id_t id)
+{
+    for (int i = 0; i < schedule_count; i++) {
+        if (schedules[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Rebuild the heap with every deadline measured from now
+static void schedule_rebase(int64_t now)
+{
+    for (int i = 0; i < schedule_count; i++) {
+        schedules[i].next_due_us = now + (int64_t)schedules[i].phase_ms * 1000;
+    }
+    for (int i = schedule_count / 2 - 1; i >= 0; i--) {
+        schedule_sift_down((uint8_t)i);
+    }
+}
+
+static TickType_t ticks_until(int64_t now, int64_t deadline_us)
+{
+    // Round up so the task never wakes before the deadline
+    int64_t tick_us = 1000000 / configTICK_RATE_HZ;
+    return deadline_us <= now ? 0 : (TickType_t)((deadline_us - now + tick_us - 1) / tick_us);
+}
+
+// Pop the earliest schedule if it is due and push it back one period later.
+// Otherwise returns false and the number of ticks until it is due.
+static bool schedule_take_due(int64_t now, sensor_id_t *id, TickType_t *wait_ticks)
+{
+    bool due = false;
+
+    portENTER_CRITICAL(&schedule_lock);
+    if (schedule_count == 0) {
+        *wait_ticks = portMAX_DELAY;
+    } else if (schedules[0].next_due_us <= now) {
+        sensor_schedule_t *next = &schedules[0];
+        *id = next->id;
+        next->next_due_us += (int64_t)next->period_ms * 1000;
+        // Skip missed periods rather than bursting to catch up
+        if (next->next_due_us <= now) {
+            next->next_due_us = now + (int64_t)next->period_ms * 1000;
+        }
+        schedule_sift_down(0);
+        due = true;
+    } else {
+        *wait_ticks = ticks_until(now, schedules[0].next_due_us);
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+
+    return due;
+}
+
+static bool sensor_channel_value(const sensor_reading_t *reading, sensor_channel_t channel, int32_t *value)
+{
+    switch (channel) {
+        case SENSOR_CHANNEL_TEMPERATURE:
+            *value = reading->data.env.temperature_centi_c;
+            return reading->type == SENSOR_TYPE_ENVIRONMENTAL;
+        case SENSOR_CHANNEL_HUMIDITY:
+            *value = reading->data.env.humidity_centi_pct;
+            return reading->type == SENSOR_TYPE_ENVIRONMENTAL;
+        case SENSOR_CHANNEL_DISTANCE:
+            *value = reading->data.distance_mm;
+            return reading->type == SENSOR_TYPE_DEPTH;
+        default:
+            return false;
+    }
+}
+
+static void sensor_channel_set(sensor_reading_t *reading, sensor_channel_t channel, int32_t value)
+{
+    switch (channel) {
+        case SENSOR_CHANNEL_TEMPERATURE:
+            reading->data.env.temperature_centi_c = (int16_t)value;
+            break;
+        case SENSOR_CHANNEL_HUMIDITY:
+            reading->data.env.humidity_centi_pct = (uint16_t)value;
+            break;
+        case SENSOR_CHANNEL_DISTANCE:
+            reading->data.distance_mm = value < 0 ? 0 : value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+            break;
+        default:
+            break;
+    }
+}
+
+// Run each filtered channel through its chain. A rejected sample keeps the channel's
+// previous output; false if nothing has been accepted for it yet.
+static bool filter_reading(sensor_reading_t *reading)
+{
+    int64_t now = esp_timer_get_time();
+    bool accepted = true;
+
+    portENTER_CRITICAL(&filter_lock);
+    for (int i = 0; i < SENSOR_FILTER_MAX_CHAINS; i++) {
+        sensor_filter_chain_t *chain = &filter_chains[i];
+        int32_t value;
+        if (!chain->in_use || chain->id != reading->id ||
+            !sensor_channel_value(reading, chain->channel, &value)) {
+            continue;
+        }
+        if (sensor_filter_apply(&chain->filter, now, &value)) {
+            chain->output = value;
+            chain->has_output = true;
+        } else if (!chain->has_output) {
+            accepted = false;
+            continue;
+        }
+        sensor_channel_set(reading, chain->channel, chain->output);
+    }
+    portEXIT_CRITICAL(&filter_lock);
+
+    return accepted;
+}
+
+static inline uint32_t history_now_s(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+static sensor_series_t *history_find(sensor_id_t id, sensor_channel_t channel)
+{
+    for (int i = 0; i < SENSOR_HISTORY_MAX_SERIES; i++) {
+        sensor_series_t *series = &history_series[i];
+        if (series->in_use && series->id == id && series->channel == channel) {
+            return series;
+        }
+    }
+    return NULL;
+}
+
+static inline uint8_t log_series_key(sensor_id_t id, sensor_channel_t channel)
+{
+    return (uint8_t)((id << 4) | channel);
+}
+
+static void history_record(const sensor_reading_t *reading)
+{
+    sensor_channel_t log_channels[SENSOR_HISTORY_MAX_SERIES];
+    int32_t log_values[SENSOR_HISTORY_MAX_SERIES];
+    int log_count = 0;
+
+    // Read the clock under the lock so windows only ever see time move forward
+    portENTER_CRITICAL(&history_lock);
+    uint32_t now_s = history_now_s();
+    for (int i = 0; i < SENSOR_HISTORY_MAX_SERIES; i++) {
+        sensor_series_t *series = &history_series[i];
+        int32_t value;
+        if (!series->in_use || series->id != reading->id ||
+            !sensor_channel_value(reading, series->channel, &value)) {
+            continue;
+        }
+        for (int span = 0; span < SENSOR_HISTORY_SPAN_MAX; span++) {
+            sensor_window_add(&series->windows[span], now_s, value);
+        }
+        if (series->logged &&
+            reading->sampled_at_us - series->logged_at_us >= SENSOR_LOG_INTERVAL_S * 1000000LL) {
+            series->logged_at_us = reading->sampled_at_us;
+            log_channels[log_count] = series->channel;
+            log_values[log_count] = value;
+            log_count++;
+        }
+    }
+    portEXIT_CRITICAL(&history_lock);
+
+    // Flash writes block, so they happen outside the spinlock
+    for (int i = 0; i < log_count; i++) {
+        tsdb_append(log_series_key(reading->id, log_channels[i]), reading->sampled_at_us, log_values[i]);
+    }
+}
+
+// Called with the owning lock held
+static void latency_record(sensor_latency_t *latency, int64_t elapsed_us)
+{
+    uint32_t us = elapsed_us < 0 ? 0 : elapsed_us > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed_us;
+    latency->last_us = us;
+    if (us > latency->max_us) {
+        latency->max_us = us;
+    }
+    if (latency->count == 0) {
+        latency->mean_us = us;
+    } else {
+        latency->mean_us = (uint32_t)((int64_t)latency->mean_us + ((int64_t)us - latency->mean_us) / 8);
+    }
+    latency->count++;
+
+    int bucket = us ? 32 - __builtin_clz(us) : 0;
+    latency->histogram[bucket < SENSOR_LATENCY_BUCKETS ? bucket : SENSOR_LATENCY_BUCKETS - 1]++;
+}
+
+uint32_t sensor_latency_percentile(const sensor_latency_t *latency, uint8_t percent)
+{
+    if (latency == NULL || latency->count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = ((uint64_t)latency->count * (percent > 100 ? 100 : percent) + 99) / 100;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < SENSOR_LATENCY_BUCKETS - 1; bucket++) {
+        seen += latency->histogram[bucket];
+        if (seen >= rank && seen > 0) {
+            uint32_t bound = bucket ? (1UL << bucket) - 1 : 0;
+            return bound < latency->max_us ? bound : latency->max_us;
+        }
+    }
+    return latency->max_us;
+}
+
+static void subscriber_push(sensor_subscriber_t *subscriber, const sensor_reading_t *reading)
+{
+    uint8_t depth = subscriber->config.queue_depth;
+
+    portENTER_CRITICAL(&subscriber_lock);
+    bool coalesced = false;
+    if (subscriber->config.policy == SENSOR_QUEUE_COALESCE) {
+        for (uint8_t i = 0; i < subscriber->len; i++) {
+            sensor_reading_t *queued = &subscriber->ring[(subscriber->head + i) % depth];
+            if (queued->id == reading->id) {
+                *queued = *reading;
+                subscriber->stats.coalesced++;
+                coalesced = true;
+                break;
+            }
+        }
+    }
+    if (!coalesced) {
+        if (subscriber->len == depth) {
+            subscriber->head = (subscriber->head + 1) % depth;
+            subscriber->len--;
+            subscriber->stats.dropped++;
+        }
+        subscriber->ring[(subscriber->head + subscriber->len) % depth] = *reading;
+        subscriber->len++;
+        if (subscriber->len > subscriber->stats.max_depth) {
+            subscriber->stats.max_depth = subscriber->len;
+        }
+    }
+    portEXIT_CRITICAL(&subscriber_lock);
+
+    xTaskNotifyGive(subscriber->task);
+}
+
+static bool subscriber_pop(sensor_subscriber_t *subscriber, sensor_reading_t *reading)
+{
+    bool popped = false;
+
+    portENTER_CRITICAL(&subscriber_lock);
+    if (subscriber->len > 0) {
+        *reading = subscriber->ring[subscriber->head];
+        subscriber->head = (subscriber->head + 1) % subscriber->config.queue_depth;
+        subscriber->len--;
+        popped = true;
+    }
+    portEXIT_CRITICAL(&subscriber_lock);
+
+    return popped;
+}
+
+static void subscriber_task(void *pvParameters)
+{
+    sensor_subscriber_t *subscriber = pvParameters;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        sensor_reading_t reading;
+        while (subscriber_pop(subscriber, &reading)) {
+            int64_t delivered_at = timing_monotonic_us();
+            subscriber->config.callback(&reading);
+
+            portENTER_CRITICAL(&subscriber_lock);
+            subscriber->stats.delivered++;
+            latency_record(&subscriber->stats.latency, delivered_at - reading.sampled_at_us);
+            portEXIT_CRITICAL(&subscriber_lock);
+        }
+    }
+}
+
+static void publish_mark(sensor_publish_t *state, const sensor_reading_t *reading, int64_t now)
+{
+    state->published = true;
+    state->published_us = now;
+    state->last = *reading;
+    state->held = false;
+}
+
+// Publish a reading if it moved past the deadband since the last published one and
+// min_interval_ms has elapsed, or if max_interval_ms has elapsed regardless. A change
+// inside min_interval_ms is held and published by publish_held_due() once it elapses,
+// unless a later reading brings the value back inside the deadband first.
+static bool publish_due(const sensor_reading_t *reading)
+{
+    sensor_publish_t *state = &publish_state[reading->id];
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&publish_lock);
+    sensor_publish_config_t config = state->config;
+    portEXIT_CRITICAL(&publish_lock);
+
+    bool due = !state->published;
+    if (!due) {
+        int64_t elapsed_ms = (now - state->published_us) / 1000;
+        bool changed = false;
+        for (int channel = 0; channel < SENSOR_CHANNEL_MAX && !changed; channel++) {
+            int32_t value, last;
+            if (sensor_channel_value(reading, channel, &value) &&
+                sensor_channel_value(&state->last, channel, &last)) {
+                int32_t change = value > last ? value - last : last - value;
+                changed = change >= config.deadband[channel];
+            }
+        }
+        if (config.max_interval_ms && elapsed_ms >= config.max_interval_ms) {
+            due = true;
+        } else if (changed && elapsed_ms >= config.min_interval_ms) {
+            due = true;
+        } else {
+            state->held = changed;
+            state->held_reading = *reading;
+        }
+    }
+
+    if (due) {
+        publish_mark(state, reading, now);
+    }
+    return due;
+}
+
+// Wake every waiter of the sensor with the result of its read
+static void waiters_complete(const sensor_reading_t *reading)
+{
+    sensor_waiter_t *done = NULL;
+
+    portENTER_CRITICAL(&waiter_lock);
+    sensor_waiter_t **link = &waiters;
+    while (*link != NULL) {
+        sensor_waiter_t *waiter = *link;
+        if (waiter->id == reading->id) {
+            *link = waiter->next;
+            waiter->next = done;
+            done = waiter;
+        } else {
+            link = &waiter->next;
+        }
+    }
+    portEXIT_CRITICAL(&waiter_lock);
+
+    // Unlinked waiters wait for their semaphore even after a timeout, so they stay valid until given
+    while (done != NULL) {
+        sensor_waiter_t *waiter = done;
+        done = waiter->next;
+        waiter->reading = *reading;
+        xSemaphoreGive(waiter->done);
+    }
+}
+
+// Wake every waiter of the sensor with an invalid reading
+static void waiters_fail(sensor_id_t id)
+{
+    sensor_reading_t failed = {
+        .id = id,
+        .valid = false,
+    };
+    sensor_get_type(id, &failed.type);
+    waiters_complete(&failed);
+}
+
+/*
+ * Adaptive sampling
+ *
+ * A change of at least the activity threshold halves the period (down to
+ * min_period_ms) and pulls in the next deadline. While the moving average
+ * of the change stays above half the threshold the period holds; once the
+ * signal settles it grows by a quarter per sample up to max_period_ms.
+ */
+static void adaptive_update(const sensor_reading_t *reading)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&schedule_lock);
+    sensor_adaptive_t *state = &adaptive_state[reading->id];
+    int pos = schedule_find(reading->id);
+    if (!state->enabled || pos < 0) {
+        portEXIT_CRITICAL(&schedule_lock);
+        return;
+    }
+
+    bool event = false;
+    bool active = false;
+    for (int channel = 0; channel < SENSOR_CHANNEL_MAX; channel++) {
+        int32_t value;
+        int32_t threshold = state->config.activity_threshold[channel];
+        if (threshold <= 0 || !sensor_channel_value(reading, channel, &value)) {
+            continue;
+        }
+        if (state->primed) {
+            int32_t change = value > state->last[channel] ? value - state->last[channel]
+                                                          : state->last[channel] - value;
+            state->activity[channel] += (change - state->activity[channel]) / 4;
+            if (change >= threshold) {
+                event = true;
+            } else if (state->activity[channel] * 2 >= threshold) {
+                active = true;
+            }
+        }
+        state->last[channel] = value;
+    }
+    state->primed = true;
+
+    sensor_schedule_t *schedule = &schedules[pos];
+    uint32_t period = schedule->period_ms;
+    if (event) {
+        period /= 2;
+    } else if (!active) {
+        period += period / 4 + 1;
+    }
+    if (period < state->config.min_period_ms) {
+        period = state->config.min_period_ms;
+    }
+    if (period > state->config.max_period_ms) {
+        period = state->config.max_period_ms;
+    }
+
+    if (period != schedule->period_ms) {
+        schedule->period_ms = period;
+        int64_t due = now + (int64_t)period * 1000;
+        if (due < schedule->next_due_us) {
+            schedule->next_due_us = due;
+            schedule_sift_up((uint8_t)pos);
+        }
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+}
+
+static void publish_stamp(sensor_reading_t *reading)
+{
+    reading->published_at_us = timing_monotonic_us();
+    portENTER_CRITICAL(&schedule_lock);
+    readings_published++;
+    portEXIT_CRITICAL(&schedule_lock);
+    portENTER_CRITICAL(&publish_lock);
+    latency_record(&publish_latency[reading->id], reading->published_at_us - reading->sampled_at_us);
+    portEXIT_CRITICAL(&publish_lock);
+}
+
+// Hand a published reading to every subscriber's queue
+static void publish_dispatch(const sensor_reading_t *reading)
+{
+    for (uint8_t i = 0; i < subscriber_count; i++) {
+        subscriber_push(&subscribers[i], reading);
+    }
+
+    if (reading->type == SENSOR_TYPE_ENVIRONMENTAL) {
+        ESP_LOGD(TAG, "Sensor update: T=%.1f°C, H=%.1f%%",
+                reading->data.env.temperature_centi_c / 100.0f,
+                reading->data.env.humidity_centi_pct / 100.0f);
+    }
+}
+
+// Store, record and publish a filtered reading
+static void sensor_publish(sensor_reading_t *reading)
+{
+    bool due = publish_due(reading);
+    if (due) {
+        publish_stamp(reading);
+    }
+
+    // Store latest reading
+    sensor_snapshot_write(&latest_readings[reading->id], reading);
+    history_record(reading);
+
+    if (!due) {
+        ESP_LOGD(TAG, "%s sensor %d unchanged, not published", sensor_get_name(reading->id), reading->id);
+        return;
+    }
+    publish_dispatch(reading);
+}
+
+// Publish held changes whose min_interval_ms has elapsed. Otherwise shortens
+// wait_ticks to the earliest one. The held reading is the sensor's latest, already
+// stored and recorded when it arrived.
+static void publish_held_due(int64_t now, TickType_t *wait_ticks)
+{
+    for (int id = 0; id < SENSOR_MAX_INSTANCES; id++) {
+        sensor_publish_t *state = &publish_state[id];
+        if (!state->held) {
+            continue;
+        }
+
+        portENTER_CRITICAL(&publish_lock);
+        int64_t due_us = state->published_us + (int64_t)state->config.min_interval_ms * 1000;
+        portEXIT_CRITICAL(&publish_lock);
+
+        if (due_us > now) {
+            TickType_t ticks = ticks_until(now, due_us);
+            if (ticks < *wait_ticks) {
+                *wait_ticks = ticks;
+            }
+            continue;
+        }
+
+        sensor_reading_t reading = state->held_reading;
+        publish_mark(state, &reading, now);
+        publish_stamp(&reading);
+        sensor_snapshot_write(&latest_readings[id], &reading);
+        publish_dispatch(&reading);
+    }
+}
+
+static void sensor_update(const sensor_reading_t *raw)
+{
+    read_in_flight[raw->id] = false;
+
+    sensor_reading_t reading = *raw;
+    bool accepted = raw->valid && filter_reading(&reading);
+
+    portENTER_CRITICAL(&schedule_lock);
+    readings_completed++;
+    if (!raw->valid) {
+        read_failures++;
+    } else if (!accepted) {
+        filter_rejects++;
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+
+    if (!raw->valid) {
+        if (read_failure_streak[raw->id]++ == 0) {
+            ESP_LOGW(TAG, "Failed to read %s sensor %d", sensor_get_name(raw->id), raw->id);
+        } else {
+            ESP_LOGD(TAG, "Failed to read %s sensor %d (%lu in a row)", sensor_get_name(raw->id), raw->id,
+                     read_failure_streak[raw->id]);
+        }
+    } else {
+        if (read_failure_streak[raw->id] > 0) {
+            ESP_LOGI(TAG, "%s sensor %d reading again after %lu failed reads", sensor_get_name(raw->id),
+                     raw->id, read_failure_streak[raw->id]);
+            read_failure_streak[raw->id] = 0;
+        }
+        if (!accepted) {
+            ESP_LOGD(TAG, "%s sensor %d sample rejected by filter", sensor_get_name(raw->id), raw->id);
+            reading.valid = false;
+        } else {
+            adaptive_update(&reading);
+            sensor_publish(&reading);
+        }
+    }
+
+    waiters_complete(&reading);
+}
+
+// Queue an event for the update task and wake it
+static bool sensor_event_post(const sensor_event_t *event, TickType_t timeout_ticks)
+{
+    if (xQueueSend(sensor_event_queue, event, timeout_ticks) != pdTRUE) {
+        return false;
+    }
+    uint8_t depth = (uint8_t)uxQueueMessagesWaiting(sensor_event_queue);
+    portENTER_CRITICAL(&schedule_lock);
+    if (depth > event_queue_max_depth) {
+        event_queue_max_depth = depth;
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+    TaskHandle_t task = sensor_update_task_handle;
+    if (task != NULL) {
+        xTaskNotify(task, SENSOR_NOTIFY_EVENT, eSetBits);
+    }
+    return true;
+}
+
+static void sensor_manager_notify(uint32_t bits)
+{
+    TaskHandle_t task = sensor_update_task_handle;
+    if (task != NULL) {
+        xTaskNotify(task, bits, eSetBits);
+    }
+}
+
+// Runs in the driver's context for asynchronous reads, or inline for synchronous ones
+static void sensor_read_done(sensor_id_t id, const sensor_reading_t *reading, void *user_ctx)
+{
+    if (xTaskGetCurrentTaskHandle() == sensor_update_task_handle) {
+        sensor_update(reading);
+        return;
+    }
+
+    portENTER_CRITICAL(&completion_lock);
+    completions[id].reading = *reading;
+    completions[id].pending = true;
+    portEXIT_CRITICAL(&completion_lock);
+    sensor_manager_notify(SENSOR_NOTIFY_READ_DONE);
+}
+
+// True if a read of the sensor is in flight (or completed inline) on return
+static bool sensor_poll(sensor_id_t id)
+{
+    if (read_in_flight[id]) {
+        ESP_LOGD(TAG, "%s sensor %d still reading, skipping deadline", sensor_get_name(id), id);
+        portENTER_CRITICAL(&schedule_lock);
+        deadlines_skipped++;
+        portEXIT_CRITICAL(&schedule_lock);
+        return true;
+    }
+
+    read_in_flight[id] = true;
+    portENTER_CRITICAL(&schedule_lock);
+    reads_started++;
+    portEXIT_CRITICAL(&schedule_lock);
+    if (!sensor_read_async(id, sensor_read_done, NULL)) {
+        read_in_flight[id] = false;
+        ESP_LOGW(TAG, "Failed to start read on %s sensor %d", sensor_get_name(id), id);
+        return false;
+    }
+    return true;
+}
+
+static uint8_t reads_in_flight(void)
+{
+    uint8_t count = 0;
+    for (int i = 0; i < SENSOR_MAX_INSTANCES; i++) {
+        count += read_in_flight[i];
+    }
+    return count;
+}
+
+static void sensor_drain_completions(void)
+{
+    for (int i = 0; i < SENSOR_MAX_INSTANCES; i++) {
         sensor_reading_t reading;
-        if (sensor_read(SENSOR_TYPE_ENVIRONMENTAL, &reading)) {
-            // Store latest reading
-            latest_readings[SENSOR_TYPE_ENVIRONMENTAL] = reading;
-
-            // Call all registered callbacks
-            for (uint8_t i = 0; i < callback_count; i++) {
-                if (callbacks[i] != NULL) {
-                    callbacks[i](&reading);
-                }
+        portENTER_CRITICAL(&completion_lock);
+        bool pending = completions[i].pending;
+        if (pending) {
+            reading = completions[i].reading;
+            completions[i].pending = false;
+        }
+        portEXIT_CRITICAL(&completion_lock);
+
+        if (pending) {
+            sensor_update(&reading);
+        }
+    }
+}
+
+static void sensor_drain_events(bool stopping)
+{
+    // Completions first, so requests see which reads are still in flight
+    sensor_drain_completions();
+
+    sensor_event_t event;
+    while (xQueueReceive(sensor_event_queue, &event, 0) == pdTRUE) {
+        if (event.type == SENSOR_EVENT_READ_REQUEST) {
+            sensor_id_t id = event.reading.id;
+            // Joins the read in flight, if any; that is not a skipped deadline. Without
+            // a read to wait for, fail requesters now rather than letting them time out.
+            if (!read_in_flight[id] && (stopping || !sensor_poll(id))) {
+                waiters_fail(id);
             }
+        }
+    }
+}
+
+// Run schedules until a stop is requested, then return at the safe point: no new reads
+// start and reads in flight are allowed to complete (or time out). Sleeps until the
+// earliest deadline or the next notification; reads run asynchronously so a slow
+// sensor never delays the others' deadlines.
+static void sensor_update_run(void)
+{
+    bool stopping = false;
+    int64_t stop_deadline_us = 0;
+
+    while (true) {
+        int64_t now = esp_timer_get_time();
+        TickType_t wait_ticks;
 
-            ESP_LOGD(TAG, "Sensor update: T=%.1f°C, H=%.1f%%",
-                    reading.data.env.temperature_c, reading.data.env.humidity_percent);
+        if (!stopping) {
+            sensor_id_t id;
+            if (schedule_take_due(now, &id, &wait_ticks)) {
+                sensor_poll(id);
+                continue;
+            }
+            publish_held_due(now, &wait_ticks);
         } else {
-            ESP_LOGW(TAG, "Failed to read environmental sensor");
+            uint8_t in_flight = reads_in_flight();
+            if (in_flight == 0) {
+                return;
+            }
+            if (now >= stop_deadline_us) {
+                ESP_LOGW(TAG, "Stopping with %d read(s) still in flight", in_flight);
+                return;
+            }
+            wait_ticks = ticks_until(now, stop_deadline_us);
         }
 
-        // Wait for next update interval
-        vTaskDelay(pdMS_TO_TICKS(update_interval_ms));
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, wait_ticks);
+        if ((bits & SENSOR_NOTIFY_STOP) && !stopping) {
+            stopping = true;
+            stop_deadline_us = esp_timer_get_time() + (int64_t)SENSOR_STOP_TIMEOUT_MS * 1000;
+            manager_state = SENSOR_MANAGER_STOPPING;
+        }
+        if (bits & SENSOR_NOTIFY_RECONFIGURE) {
+            portENTER_CRITICAL(&schedule_lock);
+            reconfigurations++;
+            portEXIT_CRITICAL(&schedule_lock);
+        }
+        sensor_drain_events(stopping);
+    }
+}
+
+static void sensor_update_task(void *pvParameters)
+{
+    while (true) {
+        ESP_LOGI(TAG, "Sensor updates running");
+        sensor_update_run();
+
+        ESP_LOGI(TAG, "Sensor updates stopped");
+        manager_state = SENSOR_MANAGER_STOPPED;
+        xSemaphoreGive(stopped_semaphore);
+
+        // Parked: late completions are still consumed so in-flight state stays accurate
+        uint32_t bits = 0;
+        while (!(bits & SENSOR_NOTIFY_START)) {
+            xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+            sensor_drain_events(true);
+        }
     }
 }
 
@@ -65,20 +987,89 @@ bool sensor_manager_init(void)
         return false;
     }
 
+    // The log is optional; logged series are only kept in RAM without it
+    if (!tsdb_init()) {
+        ESP_LOGW(TAG, "Sensor log unavailable");
+    }
+
+    stopped_semaphore = xSemaphoreCreateBinaryStatic(&stopped_semaphore_buffer);
+    sensor_event_queue = xQueueCreateStatic(APP_SENSOR_EVENT_QUEUE_LEN, sizeof(sensor_event_t),
+                                            sensor_event_queue_storage, &sensor_event_queue_buffer);
+    app_resources_register_queue("sensor_events", sensor_event_queue,
+                                 APP_SENSOR_EVENT_QUEUE_LEN, sizeof(sensor_event_t));
+
     // Initialize latest readings with invalid data
-    for (int i = 0; i <= SENSOR_TYPE_VEHICLE_PRESENCE; i++) {
-        latest_readings[i].type = (sensor_type_t)i;
-        latest_readings[i].valid = false;
-        latest_readings[i].timestamp = 0;
+    for (int i = 0; i < SENSOR_MAX_INSTANCES; i++) {
+        sensor_reading_t empty = {
+            .id = (sensor_id_t)i,
+            .valid = false,
+        };
+        sensor_get_type((sensor_id_t)i, &empty.type);
+        sensor_snapshot_write(&latest_readings[i], &empty);
     }
 
     ESP_LOGI(TAG, "Sensor manager initialized successfully");
     return true;
 }
 
+bool sensor_manager_schedule(sensor_id_t id, uint32_t period_ms, uint32_t phase_ms)
+{
+    if (id >= sensor_count() || period_ms == 0) {
+        ESP_LOGE(TAG, "Invalid schedule for sensor %d: %lu ms", id, period_ms);
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool added = true;
+
+    portENTER_CRITICAL(&schedule_lock);
+    int pos = schedule_find(id);
+    if (pos >= 0) {
+        schedule_remove_at((uint8_t)pos);
+    }
+    if (schedule_count < SENSOR_MANAGER_MAX_SCHEDULES) {
+        schedules[schedule_count] = (sensor_schedule_t) {
+            .id = id,
+            .period_ms = period_ms,
+            .base_period_ms = period_ms,
+            .phase_ms = phase_ms,
+            .next_due_us = now + (int64_t)phase_ms * 1000,
+        };
+        schedule_sift_up(schedule_count++);
+    } else {
+        added = false;
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+
+    if (!added) {
+        ESP_LOGE(TAG, "Maximum number of schedules reached (%d)", SENSOR_MANAGER_MAX_SCHEDULES);
+        return false;
+    }
+
+    ESP_LOGI(TAG, "%s sensor %d every %lu ms, phase %lu ms", sensor_get_name(id), id, period_ms, phase_ms);
+    sensor_manager_notify(SENSOR_NOTIFY_RECONFIGURE);
+    return true;
+}
+
+bool sensor_manager_unschedule(sensor_id_t id)
+{
+    portENTER_CRITICAL(&schedule_lock);
+    int pos = schedule_find(id);
+    if (pos >= 0) {
+        schedule_remove_at((uint8_t)pos);
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+
+    if (pos < 0) {
+        return false;
+    }
+    sensor_manager_notify(SENSOR_NOTIFY_RECONFIGURE);
+    return true;
+}
+
 bool sensor_manager_start_updates(uint32_t interval_ms)
 {
-    if (sensor_update_task_handle != NULL) {
+    if (manager_state != SENSOR_MANAGER_STOPPED) {
         ESP_LOGW(TAG, "Sensor update task already running");
         return false;
     }
@@ -88,20 +1079,38 @@ bool sensor_manager_start_updates(uint32_t interval_ms)
         return false;
     }
 
-    update_interval_ms = interval_ms;
+    // Without explicit schedules, poll every registered sensor at interval_ms
+    portENTER_CRITICAL(&schedule_lock);
+    uint8_t count = schedule_count;
+    portEXIT_CRITICAL(&schedule_lock);
+    if (count == 0) {
+        for (sensor_id_t id = 0; id < sensor_count(); id++) {
+            if (!sensor_manager_schedule(id, interval_ms, SENSOR_STARTUP_DELAY_MS)) {
+                return false;
+            }
+        }
+        count = (uint8_t)sensor_count();
+    }
 
-    ESP_LOGI(TAG, "Starting sensor updates with %lu ms interval", interval_ms);
+    // Phases count from the start of updates
+    portENTER_CRITICAL(&schedule_lock);
+    schedule_rebase(esp_timer_get_time());
+    portEXIT_CRITICAL(&schedule_lock);
 
-    BaseType_t result = xTaskCreate(sensor_update_task,
-                                   "sensor_update",
-                                   SENSOR_UPDATE_TASK_STACK_SIZE,
-                                   NULL,
-                                   SENSOR_UPDATE_TASK_PRIORITY,
-                                   &sensor_update_task_handle);
+    ESP_LOGI(TAG, "Starting sensor updates for %d schedule(s)", count);
 
-    if (result != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create sensor update task");
-        return false;
+    manager_state = SENSOR_MANAGER_RUNNING;
+    if (sensor_update_task_handle == NULL) {
+        sensor_update_task_handle = xTaskCreateStatic(sensor_update_task,
+                                                      "sensor_update",
+                                                      APP_SENSOR_TASK_STACK_SIZE,
+                                                      NULL,
+                                                      APP_SENSOR_TASK_PRIORITY,
+                                                      sensor_update_task_stack,
+                                                      &sensor_update_task_buffer);
+        app_resources_register_task(sensor_update_task_handle, APP_SENSOR_TASK_STACK_SIZE);
+    } else {
+        sensor_manager_notify(SENSOR_NOTIFY_START);
     }
 
     return true;
@@ -109,44 +1118,492 @@ bool sensor_manager_start_updates(uint32_t interval_ms)
 
 bool sensor_manager_stop_updates(void)
 {
-    if (sensor_update_task_handle == NULL) {
+    if (manager_state != SENSOR_MANAGER_RUNNING) {
         ESP_LOGW(TAG, "Sensor update task not running");
         return false;
     }
 
     ESP_LOGI(TAG, "Stopping sensor update task");
 
-    vTaskDelete(sensor_update_task_handle);
-    sensor_update_task_handle = NULL;
-    update_interval_ms = 0;
+    xSemaphoreTake(stopped_semaphore, 0);
+    sensor_manager_notify(SENSOR_NOTIFY_STOP);
+    if (xSemaphoreTake(stopped_semaphore, pdMS_TO_TICKS(SENSOR_STOP_TIMEOUT_MS + 1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Sensor update task did not stop");
+        return false;
+    }
+
+    tsdb_flush();
+    return true;
+}
+
+bool sensor_manager_set_period(sensor_id_t id, uint32_t period_ms)
+{
+    if (period_ms == 0) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&schedule_lock);
+    int pos = schedule_find(id);
+    if (pos >= 0) {
+        sensor_schedule_t *schedule = &schedules[pos];
+        schedule->base_period_ms = period_ms;
+        schedule->period_ms = period_ms;
+        // Applies from now: a shorter period pulls the next read in, a longer one pushes it out
+        schedule->next_due_us = now + (int64_t)period_ms * 1000;
+        schedule_sift_down((uint8_t)pos);
+        schedule_sift_up((uint8_t)pos);
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+
+    if (pos < 0) {
+        return false;
+    }
+    sensor_manager_notify(SENSOR_NOTIFY_RECONFIGURE);
+    return true;
+}
+
+bool sensor_manager_get_status(sensor_manager_status_t *status)
+{
+    if (status == NULL) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&schedule_lock);
+    status->state = manager_state;
+    status->schedules = schedule_count;
+    status->next_due_in_ms = schedule_count ? (schedules[0].next_due_us - now) / 1000 : -1;
+    status->reads_started = reads_started;
+    status->deadlines_skipped = deadlines_skipped;
+    status->reconfigurations = reconfigurations;
+    status->readings = readings_completed;
+    status->read_failures = read_failures;
+    status->filter_rejects = filter_rejects;
+    status->published = readings_published;
+    status->event_queue_max_depth = event_queue_max_depth;
+    portEXIT_CRITICAL(&schedule_lock);
+    status->reads_in_flight = reads_in_flight();
+    status->event_queue_depth = sensor_event_queue ? (uint8_t)uxQueueMessagesWaiting(sensor_event_queue) : 0;
+
+    return true;
+}
+
+static void report_latency(const char *label, const sensor_latency_t *latency)
+{
+    ESP_LOGI(TAG, "  %s: %lu readings, p50 %lu us, p90 %lu us, p99 %lu us, max %lu us", label,
+             latency->count,
+             sensor_latency_percentile(latency, 50),
+             sensor_latency_percentile(latency, 90),
+             sensor_latency_percentile(latency, 99),
+             latency->max_us);
+}
+
+void sensor_manager_report(void)
+{
+    sensor_manager_status_t status;
+    sensor_manager_get_status(&status);
+
+    // Throughput since the previous report, in hundredths of a reading per second
+    int64_t now = timing_monotonic_us();
+    int64_t elapsed_us = now - report_at_us;
+    uint32_t rate_centi = elapsed_us > 0 ?
+                          (uint32_t)((int64_t)(status.readings - report_readings) * 100000000LL / elapsed_us) : 0;
+    report_readings = status.readings;
+    report_at_us = now;
+
+    ESP_LOGI(TAG, "Sensor pipeline: %lu readings (%lu.%02lu/s), %lu failed, %lu rejected, %lu published",
+             status.readings, rate_centi / 100, rate_centi % 100,
+             status.read_failures, status.filter_rejects, status.published);
+    ESP_LOGI(TAG, "  reads started %lu, deadlines skipped %lu, in flight %d, events %d/%d (max %d)",
+             status.reads_started, status.deadlines_skipped, status.reads_in_flight,
+             status.event_queue_depth, APP_SENSOR_EVENT_QUEUE_LEN, status.event_queue_max_depth);
+
+    for (sensor_id_t id = 0; id < sensor_count(); id++) {
+        sensor_latency_t latency;
+        portENTER_CRITICAL(&publish_lock);
+        latency = publish_latency[id];
+        portEXIT_CRITICAL(&publish_lock);
+        if (latency.count > 0) {
+            report_latency(sensor_get_name(id), &latency);
+        }
+    }
+
+    for (uint8_t i = 0; i < subscriber_count; i++) {
+        sensor_subscriber_stats_t stats;
+        sensor_manager_get_subscriber_stats(i, &stats);
+        ESP_LOGI(TAG, "  %s: %lu delivered, %lu dropped, %lu coalesced, depth %d (max %d)",
+                 subscribers[i].config.name, stats.delivered, stats.dropped, stats.coalesced,
+                 stats.depth, stats.max_depth);
+        report_latency(subscribers[i].config.name, &stats.latency);
+    }
+
+    app_resources_report();
+}
+
+bool sensor_manager_subscribe(const sensor_subscriber_config_t *config, uint8_t *ret_id)
+{
+    if (config == NULL || config->callback == NULL ||
+        config->queue_depth == 0 || config->queue_depth > SENSOR_SUBSCRIBER_QUEUE_MAX) {
+        ESP_LOGE(TAG, "Invalid subscriber configuration");
+        return false;
+    }
+
+    if (subscriber_count >= SENSOR_MANAGER_MAX_SUBSCRIBERS) {
+        ESP_LOGE(TAG, "Maximum number of subscribers reached (%d)", SENSOR_MANAGER_MAX_SUBSCRIBERS);
+        return false;
+    }
+
+    sensor_subscriber_t *subscriber = &subscribers[subscriber_count];
+    *subscriber = (sensor_subscriber_t) {
+        .config = *config,
+    };
+    if (subscriber->config.name == NULL) {
+        subscriber->config.name = "sensor_sub";
+    }
+
+    subscriber->task = xTaskCreateStatic(subscriber_task,
+                                         subscriber->config.name,
+                                         APP_SENSOR_SUBSCRIBER_TASK_STACK_SIZE,
+                                         subscriber,
+                                         APP_SENSOR_SUBSCRIBER_TASK_PRIORITY,
+                                         subscriber->task_stack,
+                                         &subscriber->task_buffer);
+    app_resources_register_task(subscriber->task, APP_SENSOR_SUBSCRIBER_TASK_STACK_SIZE);
+
+    if (ret_id) {
+        *ret_id = subscriber_count;
+    }
+    subscriber_count++;
+    ESP_LOGI(TAG, "Registered sensor subscriber %s (%d/%d)", subscriber->config.name,
+             subscriber_count, SENSOR_MANAGER_MAX_SUBSCRIBERS);
 
     return true;
 }
 
 bool sensor_manager_register_callback(sensor_update_callback_t callback)
 {
-    if (callback == NULL) {
-        ESP_LOGE(TAG, "Invalid callback function");
+    sensor_subscriber_config_t config = {
+        .callback = callback,
+        .queue_depth = SENSOR_SUBSCRIBER_DEFAULT_DEPTH,
+        .policy = SENSOR_QUEUE_COALESCE,
+    };
+    return sensor_manager_subscribe(&config, NULL);
+}
+
+bool sensor_manager_get_subscriber_stats(uint8_t id, sensor_subscriber_stats_t *stats)
+{
+    if (id >= subscriber_count || stats == NULL) {
         return false;
     }
 
-    if (callback_count >= MAX_CALLBACKS) {
-        ESP_LOGE(TAG, "Maximum number of callbacks reached (%d)", MAX_CALLBACKS);
+    portENTER_CRITICAL(&subscriber_lock);
+    *stats = subscribers[id].stats;
+    stats->depth = subscribers[id].len;
+    portEXIT_CRITICAL(&subscriber_lock);
+    return true;
+}
+
+bool sensor_manager_get_latest_reading(sensor_id_t id, sensor_reading_t *reading)
+{
+    if (reading == NULL || id >= SENSOR_MAX_INSTANCES) {
         return false;
     }
 
-    callbacks[callback_count++] = callback;
-    ESP_LOGI(TAG, "Registered sensor callback (%d/%d)", callback_count, MAX_CALLBACKS);
+    sensor_snapshot_read(&latest_readings[id], reading);
+    return reading->valid;
+}
+
+bool sensor_manager_enable_history(sensor_id_t id, sensor_channel_t channel)
+{
+    if (id >= sensor_count() || channel >= SENSOR_CHANNEL_MAX) {
+        return false;
+    }
+
+    bool enabled = false;
+    portENTER_CRITICAL(&history_lock);
+    if (history_find(id, channel) != NULL) {
+        enabled = true;
+    } else {
+        for (int i = 0; i < SENSOR_HISTORY_MAX_SERIES; i++) {
+            sensor_series_t *series = &history_series[i];
+            if (series->in_use) {
+                continue;
+            }
+            series->in_use = true;
+            series->id = id;
+            series->channel = channel;
+            for (int span = 0; span < SENSOR_HISTORY_SPAN_MAX; span++) {
+                sensor_window_init(&series->windows[span], history_span_s[span]);
+            }
+            enabled = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&history_lock);
+
+    if (!enabled) {
+        ESP_LOGE(TAG, "Maximum number of history series reached (%d)", SENSOR_HISTORY_MAX_SERIES);
+    }
+    return enabled;
+}
+
+bool sensor_manager_get_history_stats(sensor_id_t id, sensor_channel_t channel,
+                                      sensor_history_span_t span, sensor_window_stats_t *stats)
+{
+    if (stats == NULL || span >= SENSOR_HISTORY_SPAN_MAX) {
+        return false;
+    }
 
+    bool found = false;
+
+    portENTER_CRITICAL(&history_lock);
+    uint32_t now_s = history_now_s();
+    sensor_series_t *series = history_find(id, channel);
+    if (series != NULL) {
+        found = sensor_window_get(&series->windows[span], now_s, stats);
+    }
+    portEXIT_CRITICAL(&history_lock);
+
+    return found;
+}
+
+bool sensor_manager_enable_log(sensor_id_t id, sensor_channel_t channel)
+{
+    if (!sensor_manager_enable_history(id, channel)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&history_lock);
+    sensor_series_t *series = history_find(id, channel);
+    if (series != NULL && !series->logged) {
+        series->logged = true;
+        series->logged_at_us = INT64_MIN / 2;   // Log the first sample
+    }
+    portEXIT_CRITICAL(&history_lock);
+
+    return series != NULL;
+}
+
+bool sensor_manager_open_log(sensor_id_t id, sensor_channel_t channel, uint32_t from_s, uint32_t to_s,
+                             tsdb_cursor_t *cursor)
+{
+    if (id >= sensor_count() || channel >= SENSOR_CHANNEL_MAX) {
+        return false;
+    }
+
+    return tsdb_cursor_open(cursor, log_series_key(id, channel), from_s, to_s);
+}
+
+bool sensor_manager_set_publish_config(sensor_id_t id, const sensor_publish_config_t *config)
+{
+    if (id >= SENSOR_MAX_INSTANCES || config == NULL) {
+        return false;
+    }
+
+    if (config->max_interval_ms && config->max_interval_ms < config->min_interval_ms) {
+        ESP_LOGE(TAG, "Invalid publish intervals for sensor %d: %lu..%lu ms", id,
+                 config->min_interval_ms, config->max_interval_ms);
+        return false;
+    }
+
+    portENTER_CRITICAL(&publish_lock);
+    publish_state[id].config = *config;
+    portEXIT_CRITICAL(&publish_lock);
     return true;
 }
 
-bool sensor_manager_get_latest_reading(sensor_type_t type, sensor_reading_t *reading)
+bool sensor_manager_set_filter(sensor_id_t id, sensor_channel_t channel, const sensor_filter_config_t *config)
 {
-    if (reading == NULL || type > SENSOR_TYPE_VEHICLE_PRESENCE) {
+    if (id >= sensor_count() || channel >= SENSOR_CHANNEL_MAX) {
         return false;
     }
 
-    *reading = latest_readings[type];
+    sensor_filter_t filter;
+    if (config != NULL && !sensor_filter_init(&filter, config)) {
+        ESP_LOGE(TAG, "Invalid filter configuration for sensor %d", id);
+        return false;
+    }
+
+    bool stored = false;
+    portENTER_CRITICAL(&filter_lock);
+    sensor_filter_chain_t *free_chain = NULL;
+    sensor_filter_chain_t *chain = NULL;
+    for (int i = 0; i < SENSOR_FILTER_MAX_CHAINS; i++) {
+        sensor_filter_chain_t *candidate = &filter_chains[i];
+        if (candidate->in_use && candidate->id == id && candidate->channel == channel) {
+            chain = candidate;
+        } else if (!candidate->in_use && free_chain == NULL) {
+            free_chain = candidate;
+        }
+    }
+    if (chain == NULL) {
+        chain = free_chain;
+    }
+    if (config == NULL) {
+        // Remove the chain, if any
+        if (chain != NULL && chain != free_chain) {
+            chain->in_use = false;
+        }
+        stored = true;
+    } else if (chain != NULL) {
+        *chain = (sensor_filter_chain_t) {
+            .in_use = true,
+            .id = id,
+            .channel = channel,
+            .filter = filter,
+        };
+        stored = true;
+    }
+    portEXIT_CRITICAL(&filter_lock);
+
+    if (!stored) {
+        ESP_LOGE(TAG, "Maximum number of filter chains reached (%d)", SENSOR_FILTER_MAX_CHAINS);
+    }
+    return stored;
+}
+
+bool sensor_manager_request_read(sensor_id_t id, uint32_t max_age_ms, uint32_t timeout_ms,
+                                 sensor_reading_t *reading)
+{
+    if (id >= sensor_count() || reading == NULL) {
+        return false;
+    }
+
+    // Serve from the latest reading if it is fresh enough
+    sensor_snapshot_read(&latest_readings[id], reading);
+    if (reading->valid && timing_monotonic_us() - reading->sampled_at_us <= (int64_t)max_age_ms * 1000) {
+        return true;
+    }
+
+    if (manager_state != SENSOR_MANAGER_RUNNING) {
+        ESP_LOGW(TAG, "Sensor updates not running, cannot read %s sensor %d", sensor_get_name(id), id);
+        return false;
+    }
+
+    sensor_waiter_t waiter = {
+        .id = id,
+    };
+    waiter.done = xSemaphoreCreateBinaryStatic(&waiter.done_buffer);
+
+    // Only the first waiter of a sensor asks for a read; later ones join it
+    bool first = true;
+    portENTER_CRITICAL(&waiter_lock);
+    for (sensor_waiter_t *other = waiters; other != NULL; other = other->next) {
+        if (other->id == id) {
+            first = false;
+            break;
+        }
+    }
+    waiter.next = waiters;
+    waiters = &waiter;
+    portEXIT_CRITICAL(&waiter_lock);
+
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    if (first) {
+        sensor_event_t event = {
+            .type = SENSOR_EVENT_READ_REQUEST,
+            .reading = { .id = id },
+        };
+        if (!sensor_event_post(&event, timeout_ticks)) {
+            // Waiters that joined rely on this request; fail them all now
+            // (this one included) rather than leave them to time out
+            ESP_LOGW(TAG, "Event queue full, cannot request a read of %s sensor %d", sensor_get_name(id), id);
+            waiters_fail(id);
+        }
+    }
+    bool completed = xSemaphoreTake(waiter.done, timeout_ticks) == pdTRUE;
+
+    if (!completed) {
+        // Unlink, unless a completion already took the waiter and is about to give the semaphore
+        bool linked = false;
+        portENTER_CRITICAL(&waiter_lock);
+        for (sensor_waiter_t **link = &waiters; *link != NULL; link = &(*link)->next) {
+            if (*link == &waiter) {
+                *link = waiter.next;
+                linked = true;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&waiter_lock);
+
+        if (linked) {
+            vSemaphoreDelete(waiter.done);
+            ESP_LOGW(TAG, "Timed out reading %s sensor %d", sensor_get_name(id), id);
+            return false;
+        }
+        xSemaphoreTake(waiter.done, portMAX_DELAY);
+    }
+
+    vSemaphoreDelete(waiter.done);
+    *reading = waiter.reading;
     return reading->valid;
-}
\ No newline at end of file
+}
+
+bool sensor_manager_set_adaptive(sensor_id_t id, const sensor_adaptive_config_t *config)
+{
+    if (id >= SENSOR_MAX_INSTANCES) {
+        return false;
+    }
+
+    if (config != NULL && (config->min_period_ms == 0 || config->max_period_ms < config->min_period_ms)) {
+        ESP_LOGE(TAG, "Invalid adaptive sampling bounds for sensor %d", id);
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&schedule_lock);
+    sensor_adaptive_t *state = &adaptive_state[id];
+    *state = (sensor_adaptive_t) { 0 };
+    int pos = schedule_find(id);
+    bool rescheduled = false;
+    if (config != NULL) {
+        state->enabled = true;
+        state->config = *config;
+    } else if (pos >= 0) {
+        // Back to the base period from now, not after a deadline stretched up to max_period_ms
+        sensor_schedule_t *schedule = &schedules[pos];
+        schedule->period_ms = schedule->base_period_ms;
+        schedule->next_due_us = now + (int64_t)schedule->period_ms * 1000;
+        schedule_sift_down((uint8_t)pos);
+        schedule_sift_up((uint8_t)pos);
+        rescheduled = true;
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+
+    if (rescheduled) {
+        sensor_manager_notify(SENSOR_NOTIFY_RECONFIGURE);
+    }
+    return true;
+}
+
+bool sensor_manager_get_sample_period(sensor_id_t id, uint32_t *period_ms)
+{
+    if (period_ms == NULL) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&schedule_lock);
+    int pos = schedule_find(id);
+    if (pos >= 0) {
+        *period_ms = schedules[pos].period_ms;
+    }
+    portEXIT_CRITICAL(&schedule_lock);
+
+    return pos >= 0;
+}
+
+bool sensor_manager_get_publish_latency(sensor_id_t id, sensor_latency_t *latency)
+{
+    if (id >= SENSOR_MAX_INSTANCES || latency == NULL) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&publish_lock);
+    *latency = publish_latency[id];
+    portEXIT_CRITICAL(&publish_lock);
+    return true;
+}
@@ -10,15 +10,150 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "sensor_interface.h"
+#include "sensor_window.h"
+#include "sensor_filter.h"
+#include "tsdb.h"
 
-// Sensor update callback type
+#define SENSOR_MANAGER_MAX_SCHEDULES 8
+#define SENSOR_HISTORY_MAX_SERIES 4
+#define SENSOR_LATENCY_BUCKETS 24          // Power-of-two latency buckets, up to ~4 s and beyond
+#define SENSOR_LOG_INTERVAL_S 60           // Resolution of the on-flash log
+#define SENSOR_FILTER_MAX_CHAINS 4
+#define SENSOR_SUBSCRIBER_QUEUE_MAX 8
+
+// Scalar channels of a reading, in the units of sensor_reading_t
+typedef enum {
+    SENSOR_CHANNEL_TEMPERATURE,      // 0.01 °C
+    SENSOR_CHANNEL_HUMIDITY,         // 0.01 %RH
+    SENSOR_CHANNEL_DISTANCE,         // mm
+    SENSOR_CHANNEL_MAX,
+} sensor_channel_t;
+
+// History windows; each slides in 1/60th steps of its length
+typedef enum {
+    SENSOR_HISTORY_15_MIN,
+    SENSOR_HISTORY_1_HOUR,
+    SENSOR_HISTORY_24_HOURS,
+    SENSOR_HISTORY_SPAN_MAX,
+} sensor_history_span_t;
+
+// Report-on-change policy applied before callbacks. All zero (the default) publishes every reading.
+typedef struct {
+    int32_t deadband[SENSOR_CHANNEL_MAX];    // Smallest change that is published, in channel units; 0 publishes all
+    uint32_t min_interval_ms;                // Changes are held back and published this long after the last publish
+    uint32_t max_interval_ms;                // Heartbeat: republish on the next reading after this long; 0 disables
+} sensor_publish_config_t;
+
+// Adaptive sampling bounds; the schedule's period is the starting point
+typedef struct {
+    uint32_t min_period_ms;
+    uint32_t max_period_ms;
+    int32_t activity_threshold[SENSOR_CHANNEL_MAX];    // Change per sample counted as activity; 0 ignores the channel
+} sensor_adaptive_config_t;
+
+typedef enum {
+    SENSOR_MANAGER_STOPPED,
+    SENSOR_MANAGER_RUNNING,
+    SENSOR_MANAGER_STOPPING,     // Waiting for reads in flight before the task exits
+} sensor_manager_state_t;
+
+typedef struct {
+    sensor_manager_state_t state;
+    uint8_t schedules;
+    uint8_t reads_in_flight;
+    int64_t next_due_in_ms;      // Until the earliest deadline; -1 if nothing is scheduled
+    uint32_t reads_started;
+    uint32_t deadlines_skipped;  // Deadlines that found the previous read still in flight
+    uint32_t reconfigurations;   // Schedule changes applied by the running task
+    uint32_t readings;           // Completed reads, including failed ones
+    uint32_t read_failures;
+    uint32_t filter_rejects;
+    uint32_t published;
+    uint8_t event_queue_depth;
+    uint8_t event_queue_max_depth;
+} sensor_manager_status_t;
+
+// Sensor update callback type; runs in the subscriber's own task
 typedef void (*sensor_update_callback_t)(const sensor_reading_t *reading);
 
+// What to do with a reading when the subscriber's queue is full
+typedef enum {
+    SENSOR_QUEUE_DROP_OLDEST,    // Drop the oldest queued reading
+    SENSOR_QUEUE_COALESCE,       // Replace a queued reading from the same sensor, else drop the oldest
+} sensor_queue_policy_t;
+
+typedef struct {
+    sensor_update_callback_t callback;
+    const char *name;            // Dispatch task name
+    uint8_t queue_depth;         // 1..SENSOR_SUBSCRIBER_QUEUE_MAX
+    sensor_queue_policy_t policy;
+} sensor_subscriber_config_t;
+
+// Latency from sampled_at_us to a later stage
+typedef struct {
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint32_t mean_us;            // Moving average (1/8 weight per reading)
+    // Bucket 0 counts 0 us, bucket b latencies of 2^(b-1) to 2^b - 1 us; the last bucket is open-ended
+    uint32_t histogram[SENSOR_LATENCY_BUCKETS];
+} sensor_latency_t;
+
+typedef struct {
+    uint32_t delivered;
+    uint32_t dropped;            // Readings lost to a full queue
+    uint32_t coalesced;          // Readings that replaced a queued one
+    uint8_t depth;               // Currently queued
+    uint8_t max_depth;           // High-water mark
+    sensor_latency_t latency;    // Sampled to callback start (end-to-end freshness)
+} sensor_subscriber_stats_t;
+
 // Sensor manager functions
 bool sensor_manager_init(void);
+// Poll a sensor every period_ms, first phase_ms after updates start (or now, if already
+// running). Replaces any existing schedule for the sensor.
+bool sensor_manager_schedule(sensor_id_t id, uint32_t period_ms, uint32_t phase_ms);
+bool sensor_manager_unschedule(sensor_id_t id);
+// Change a scheduled sensor's period; the next read is due one new period from now
+bool sensor_manager_set_period(sensor_id_t id, uint32_t period_ms);
+// Let the sensor's period follow signal activity within bounds; NULL restores the scheduled period from now
+bool sensor_manager_set_adaptive(sensor_id_t id, const sensor_adaptive_config_t *config);
+// Current effective sampling period
+bool sensor_manager_get_sample_period(sensor_id_t id, uint32_t *period_ms);
+// Start the update task; interval_ms schedules every registered sensor if nothing was scheduled
 bool sensor_manager_start_updates(uint32_t interval_ms);
+// Stops at a safe point: no new reads start and the task exits once reads in flight complete
 bool sensor_manager_stop_updates(void);
+bool sensor_manager_get_status(sensor_manager_status_t *status);
+// Log throughput since the previous report, latency percentiles, queue depths and memory
+void sensor_manager_report(void);
+// Upper bound of the bucket holding the given percentile, capped at max_us; 0 without samples
+uint32_t sensor_latency_percentile(const sensor_latency_t *latency, uint8_t percent);
+bool sensor_manager_subscribe(const sensor_subscriber_config_t *config, uint8_t *ret_id);
+// Subscribe with a default-depth coalescing queue
 bool sensor_manager_register_callback(sensor_update_callback_t callback);
-bool sensor_manager_get_latest_reading(sensor_type_t type, sensor_reading_t *reading);
+bool sensor_manager_get_subscriber_stats(uint8_t id, sensor_subscriber_stats_t *stats);
+// Lock-free and safe from any task; never blocks the update task
+bool sensor_manager_get_latest_reading(sensor_id_t id, sensor_reading_t *reading);
+// Return a reading no older than max_age_ms, reading the sensor if needed. Concurrent
+// requests for a sensor share a single read, as does the scheduled read in flight.
+// Blocks for up to timeout_ms; requires updates to be running.
+bool sensor_manager_request_read(sensor_id_t id, uint32_t max_age_ms, uint32_t timeout_ms,
+                                 sensor_reading_t *reading);
+// Filter a channel of a sensor before it is stored or published; NULL removes the chain
+bool sensor_manager_set_filter(sensor_id_t id, sensor_channel_t channel, const sensor_filter_config_t *config);
+bool sensor_manager_set_publish_config(sensor_id_t id, const sensor_publish_config_t *config);
+// Sampled to published: filtering and scheduling delay inside the sensor manager
+bool sensor_manager_get_publish_latency(sensor_id_t id, sensor_latency_t *latency);
+// Keep min/max/mean history for a channel of a sensor (statically pooled)
+bool sensor_manager_enable_history(sensor_id_t id, sensor_channel_t channel);
+// O(1); false if history is not enabled or the window holds no samples
+bool sensor_manager_get_history_stats(sensor_id_t id, sensor_channel_t channel,
+                                      sensor_history_span_t span, sensor_window_stats_t *stats);
+// Also append the channel to the on-flash log, one sample per SENSOR_LOG_INTERVAL_S; enables history
+bool sensor_manager_enable_log(sensor_id_t id, sensor_channel_t channel);
+// Stream logged samples with log times from_s..to_s (see tsdb_log_time_s) through tsdb_cursor_next()
+bool sensor_manager_open_log(sensor_id_t id, sensor_channel_t channel, uint32_t from_s, uint32_t to_s,
+                             tsdb_cursor_t *cursor);
 
 #endif // SENSOR_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*
+ * Latest Reading Snapshots
+ *
+ * Single-writer, many-reader publication of a sensor_reading_t without
+ * locking. Each snapshot is a latched seqlock: two copies of the reading
+ * and a sequence counter whose low bit selects the copy readers use. The
+ * writer always updates the copy readers are not directed to, so a reader
+ * that preempts the writer still finds a stable copy and never spins on it.
+ *
+ * Writers must be serialised by the caller; readers may run anywhere.
+ */
+
+#ifndef SENSOR_SNAPSHOT_H
+#define SENSOR_SNAPSHOT_H
+
+#include <stdint.h>
+#include "sensor_interface.h"
+
+typedef struct {
+    uint32_t seq;
+    sensor_reading_t copies[2];
+} sensor_snapshot_t;
+
+static inline void sensor_snapshot_write(sensor_snapshot_t *snapshot, const sensor_reading_t *reading)
+{
+    uint32_t seq = snapshot->seq;
+
+    // Odd: readers use copies[1] while copies[0] is updated
+    __atomic_store_n(&snapshot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    snapshot->copies[0] = *reading;
+
+    // Even: readers use copies[0] while copies[1] is updated
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&snapshot->seq, seq + 2, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    snapshot->copies[1] = *reading;
+}
+
+static inline void sensor_snapshot_read(const sensor_snapshot_t *snapshot, sensor_reading_t *reading)
+{
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&snapshot->seq, __ATOMIC_ACQUIRE);
+        *reading = snapshot->copies[seq & 1];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&snapshot->seq, __ATOMIC_RELAXED) != seq);
+}
+
+#endif // SENSOR_SNAPSHOT_H
@@ -0,0 +1,138 @@
+/*
+ * Sensor Sliding Window Implementation
+ */
+
+#include <string.h>
+#include "sensor_window.h"
+
+static inline sensor_window_extreme_t *deque_at(sensor_window_deque_t *deque, uint8_t i)
+{
+    return &deque->entries[(deque->head + i) % SENSOR_WINDOW_BUCKETS];
+}
+
+// Drop entries that can never be the extreme again, then append
+static void deque_push(sensor_window_deque_t *deque, uint32_t bucket, int32_t value, bool is_min)
+{
+    while (deque->len > 0) {
+        int32_t back = deque_at(deque, deque->len - 1)->value;
+        if (is_min ? back < value : back > value) {
+            break;
+        }
+        deque->len--;
+    }
+    *deque_at(deque, deque->len) = (sensor_window_extreme_t) { .bucket = bucket, .value = value };
+    deque->len++;
+}
+
+static void deque_evict(sensor_window_deque_t *deque, uint32_t oldest)
+{
+    while (deque->len > 0 && (int32_t)(deque->entries[deque->head].bucket - oldest) < 0) {
+        deque->head = (deque->head + 1) % SENSOR_WINDOW_BUCKETS;
+        deque->len--;
+    }
+}
+
+static void window_reset(sensor_window_t *window, uint32_t bucket)
+{
+    memset(window->slots, 0, sizeof(window->slots));
+    window->closed_sum = 0;
+    window->closed_count = 0;
+    window->min_deque.head = window->min_deque.len = 0;
+    window->max_deque.head = window->max_deque.len = 0;
+    window->current = bucket;
+    window->open = (sensor_window_slot_t) { .bucket = bucket };
+    window->started = true;
+}
+
+// Close the open bucket and open the next one, evicting the bucket that leaves the window
+static void window_step(sensor_window_t *window)
+{
+    sensor_window_slot_t *slot = &window->slots[window->current % SENSOR_WINDOW_BUCKETS];
+    *slot = window->open;
+    window->closed_sum += slot->sum;
+    window->closed_count += slot->count;
+    if (slot->count > 0) {
+        deque_push(&window->min_deque, window->current, window->current_min, true);
+        deque_push(&window->max_deque, window->current, window->current_max, false);
+    }
+
+    window->current++;
+    window->open = (sensor_window_slot_t) { .bucket = window->current };
+
+    // The open bucket plus SENSOR_WINDOW_BUCKETS - 1 closed ones make up the window
+    sensor_window_slot_t *leaving = &window->slots[window->current % SENSOR_WINDOW_BUCKETS];
+    window->closed_sum -= leaving->sum;
+    window->closed_count -= leaving->count;
+    *leaving = (sensor_window_slot_t) { 0 };
+    uint32_t oldest = window->current - (SENSOR_WINDOW_BUCKETS - 1);
+    deque_evict(&window->min_deque, oldest);
+    deque_evict(&window->max_deque, oldest);
+}
+
+// Slide the window up to now_s. A time behind the open bucket (a sample
+// timestamped just before a query advanced the window) is clamped to it.
+static void window_advance(sensor_window_t *window, uint32_t now_s)
+{
+    uint32_t bucket = now_s / window->bucket_s;
+    int32_t ahead = (int32_t)(bucket - window->current);
+    if (!window->started || ahead >= SENSOR_WINDOW_BUCKETS) {
+        window_reset(window, bucket);
+        return;
+    }
+    while (ahead-- > 0) {
+        window_step(window);
+    }
+}
+
+void sensor_window_init(sensor_window_t *window, uint32_t window_s)
+{
+    memset(window, 0, sizeof(*window));
+    window->bucket_s = window_s / SENSOR_WINDOW_BUCKETS;
+    if (window->bucket_s == 0) {
+        window->bucket_s = 1;
+    }
+}
+
+void sensor_window_add(sensor_window_t *window, uint32_t now_s, int32_t value)
+{
+    window_advance(window, now_s);
+
+    if (window->open.count == 0 || value < window->current_min) {
+        window->current_min = value;
+    }
+    if (window->open.count == 0 || value > window->current_max) {
+        window->current_max = value;
+    }
+    window->open.sum += value;
+    window->open.count++;
+}
+
+bool sensor_window_get(sensor_window_t *window, uint32_t now_s, sensor_window_stats_t *stats)
+{
+    if (!window->started) {
+        return false;
+    }
+    window_advance(window, now_s);
+
+    uint32_t count = window->closed_count + window->open.count;
+    if (count == 0) {
+        return false;
+    }
+
+    bool have_closed = window->min_deque.len > 0;
+    bool have_open = window->open.count > 0;
+    int32_t min = have_closed ? window->min_deque.entries[window->min_deque.head].value : window->current_min;
+    int32_t max = have_closed ? window->max_deque.entries[window->max_deque.head].value : window->current_max;
+    if (have_open && window->current_min < min) {
+        min = window->current_min;
+    }
+    if (have_open && window->current_max > max) {
+        max = window->current_max;
+    }
+
+    stats->min = min;
+    stats->max = max;
+    stats->mean = (int32_t)((window->closed_sum + window->open.sum) / (int64_t)count);
+    stats->count = count;
+    return true;
+}
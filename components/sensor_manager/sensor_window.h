@@ -0,0 +1,71 @@
+/*
+ * Sensor Sliding Window
+ *
+ * Min/max/mean of a scalar over a sliding time window in statically sized
+ * memory. Samples are folded into SENSOR_WINDOW_BUCKETS time buckets; closed
+ * buckets feed monotonic deques for min and max and running sums for the
+ * mean, so adding a sample is amortized O(1) and a query is O(1).
+ * The window slides in whole buckets (window length / SENSOR_WINDOW_BUCKETS).
+ * Has no ESP-IDF dependencies.
+ */
+
+#ifndef SENSOR_WINDOW_H
+#define SENSOR_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SENSOR_WINDOW_BUCKETS 60
+
+typedef struct {
+    int32_t min;
+    int32_t max;
+    int32_t mean;
+    uint32_t count;              // Samples in the window
+} sensor_window_stats_t;
+
+// Closed bucket, indexed by bucket number % SENSOR_WINDOW_BUCKETS
+typedef struct {
+    uint32_t bucket;
+    int32_t sum;
+    uint32_t count;
+} sensor_window_slot_t;
+
+// Monotonic deque entry: extreme value of one closed bucket
+typedef struct {
+    uint32_t bucket;
+    int32_t value;
+} sensor_window_extreme_t;
+
+typedef struct {
+    sensor_window_extreme_t entries[SENSOR_WINDOW_BUCKETS];
+    uint8_t head;
+    uint8_t len;
+} sensor_window_deque_t;
+
+typedef struct {
+    uint32_t bucket_s;
+    bool started;
+
+    // Open bucket
+    uint32_t current;
+    int32_t current_min;
+    int32_t current_max;
+    sensor_window_slot_t open;
+
+    // Closed buckets still inside the window
+    sensor_window_slot_t slots[SENSOR_WINDOW_BUCKETS];
+    int64_t closed_sum;
+    uint32_t closed_count;
+    sensor_window_deque_t min_deque;     // Increasing values
+    sensor_window_deque_t max_deque;     // Decreasing values
+} sensor_window_t;
+
+// window_s is rounded down to a multiple of SENSOR_WINDOW_BUCKETS seconds (at least one per bucket)
+void sensor_window_init(sensor_window_t *window, uint32_t window_s);
+// A sample older than the newest bucket seen so far is counted in that bucket
+void sensor_window_add(sensor_window_t *window, uint32_t now_s, int32_t value);
+// False if the window holds no samples
+bool sensor_window_get(sensor_window_t *window, uint32_t now_s, sensor_window_stats_t *stats);
+
+#endif // SENSOR_WINDOW_H
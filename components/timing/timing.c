@@ -0,0 +1,63 @@
+/*
+ * Timing Utility Implementation
+ *
+ * ESP-IDF backend using the CPU cycle counter
+ */
+
+#include "timing.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+#define TIMING_CALIBRATION_SAMPLES 8
+
+static uint32_t s_cycles_per_us = 0;
+static uint32_t s_read_overhead = 0;
+
+void timing_init(void)
+{
+    s_cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+
+    // Smallest back-to-back read distance is the fixed cost of a timestamp
+    uint32_t overhead = UINT32_MAX;
+    for (int i = 0; i < TIMING_CALIBRATION_SAMPLES; i++) {
+        timing_cycles_t a = timing_cycles_now();
+        timing_cycles_t b = timing_cycles_now();
+        if (b - a < overhead) {
+            overhead = b - a;
+        }
+    }
+    s_read_overhead = overhead;
+}
+
+uint32_t timing_cycles_per_us(void)
+{
+    if (s_cycles_per_us == 0) {
+        timing_init();
+    }
+    return s_cycles_per_us;
+}
+
+uint32_t timing_read_overhead_cycles(void)
+{
+    if (s_cycles_per_us == 0) {
+        timing_init();
+    }
+    return s_read_overhead;
+}
+
+void timing_delay_us(uint32_t us)
+{
+    timing_cycles_t start = timing_cycles_now();
+    timing_cycles_t target = timing_us_to_cycles(us);
+    uint32_t overhead = timing_read_overhead_cycles();
+
+    target = target > overhead ? target - overhead : 0;
+    while ((timing_cycles_t)(timing_cycles_now() - start) < target) {
+        // Busy wait
+    }
+}
+
+int64_t timing_monotonic_us(void)
+{
+    return esp_timer_get_time();
+}
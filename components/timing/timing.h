@@ -0,0 +1,72 @@
+/*
+ * Timing Utility Header
+ *
+ * Cycle-counter timestamps and calibrated short delays for bit-banged and
+ * single-wire protocol drivers. Reading the CPU cycle counter costs a few
+ * cycles, versus the much larger call overhead of esp_timer_get_time().
+ *
+ * On ESP-IDF builds the cycle counter is read inline. Other builds link
+ * timing_host.c, a mock with a virtual clock that tests can drive.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Raw CPU cycle count; 32 bits, wraps every few tens of seconds at 160 MHz.
+// Only differences of nearby timestamps are meaningful.
+typedef uint32_t timing_cycles_t;
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+
+static inline timing_cycles_t timing_cycles_now(void)
+{
+    return (timing_cycles_t)esp_cpu_get_cycle_count();
+}
+#else
+timing_cycles_t timing_cycles_now(void);
+#endif
+
+// Calibrate the cycle rate and read overhead; called lazily if omitted
+void timing_init(void);
+
+// CPU cycles per microsecond
+uint32_t timing_cycles_per_us(void);
+
+// Cycles consumed by a timing_cycles_now() pair, subtracted from delays
+uint32_t timing_read_overhead_cycles(void);
+
+static inline uint32_t timing_cycles_to_us(timing_cycles_t cycles)
+{
+    return cycles / timing_cycles_per_us();
+}
+
+static inline timing_cycles_t timing_us_to_cycles(uint32_t us)
+{
+    return us * timing_cycles_per_us();
+}
+
+// Microseconds elapsed since a cycle timestamp
+static inline uint32_t timing_elapsed_us(timing_cycles_t start)
+{
+    return timing_cycles_to_us(timing_cycles_now() - start);
+}
+
+// Busy-wait for a short interval. Only meant for protocol timings of a few
+// tens of microseconds; longer waits should block on a timer instead.
+void timing_delay_us(uint32_t us);
+
+// 64-bit monotonic microseconds since boot; does not wrap in practice
+int64_t timing_monotonic_us(void);
+
+#ifndef ESP_PLATFORM
+// Host mock controls: the virtual clock only moves when told to
+void timing_mock_set_cycles_per_us(uint32_t cycles_per_us);
+void timing_mock_advance_us(uint32_t us);
+void timing_mock_advance_cycles(uint32_t cycles);
+#endif
+
+#endif // TIMING_H
@@ -0,0 +1,60 @@
+/*
+ * Timing Utility Host Mock
+ *
+ * Linux/host backend with a virtual clock. Time only advances through the
+ * timing_mock_* controls or timing_delay_us(), so protocol code can be
+ * exercised deterministically off-target.
+ */
+
+#include "timing.h"
+
+#define TIMING_MOCK_DEFAULT_CYCLES_PER_US 160   // ESP32-C6 at 160 MHz
+
+static uint32_t s_cycles_per_us = TIMING_MOCK_DEFAULT_CYCLES_PER_US;
+static uint64_t s_cycles = 0;
+
+timing_cycles_t timing_cycles_now(void)
+{
+    return (timing_cycles_t)s_cycles;
+}
+
+void timing_init(void)
+{
+}
+
+uint32_t timing_cycles_per_us(void)
+{
+    return s_cycles_per_us;
+}
+
+uint32_t timing_read_overhead_cycles(void)
+{
+    return 0;
+}
+
+void timing_delay_us(uint32_t us)
+{
+    timing_mock_advance_us(us);
+}
+
+int64_t timing_monotonic_us(void)
+{
+    return (int64_t)(s_cycles / s_cycles_per_us);
+}
+
+void timing_mock_set_cycles_per_us(uint32_t cycles_per_us)
+{
+    if (cycles_per_us > 0) {
+        s_cycles_per_us = cycles_per_us;
+    }
+}
+
+void timing_mock_advance_us(uint32_t us)
+{
+    s_cycles += (uint64_t)us * s_cycles_per_us;
+}
+
+void timing_mock_advance_cycles(uint32_t cycles)
+{
+    s_cycles += cycles;
+}
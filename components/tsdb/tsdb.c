@@ -0,0 +1,553 @@
+/*
+ * On-Flash Time-Series Store Implementation
+ *
+ * Sector layout: a sector header, then blocks back to back. A block is a
+ * header followed by its compressed payload. The header is written with
+ * state 0xFF, then the payload, then the state byte is programmed to 0x00;
+ * blocks without that commit are skipped, so a power cut during a write
+ * loses only the block being written.
+ */
+
+#include <string.h>
+#include <stddef.h>
+#include "tsdb.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "app_resources.h"
+#include "timing.h"
+
+static const char *TAG = "TSDB";
+
+#define TSDB_SECTOR_SIZE 4096
+#define TSDB_SECTOR_MAGIC 0x42445354     // "TSDB"
+#define TSDB_BLOCK_MAGIC 0x4B42          // "BK"
+#define TSDB_ERASED_MAGIC 0xFFFF
+#define TSDB_FORMAT_VERSION 1
+#define TSDB_BLOCK_COMMITTED 0x00
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;                // Increases by one per sector written, never 0xFFFFFFFF
+    uint8_t version;
+    uint8_t reserved[7];
+} tsdb_sector_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint8_t state;
+    uint8_t series;
+    uint16_t count;
+    uint16_t payload_len;
+    uint32_t first_ts;
+    uint32_t last_ts;
+} tsdb_block_header_t;
+
+_Static_assert(sizeof(tsdb_sector_header_t) == 16, "Sector header layout changed");
+_Static_assert(sizeof(tsdb_block_header_t) == 16, "Block header layout changed");
+
+// Open block of one series
+typedef struct {
+    uint8_t series;              // TSDB_SERIES_INVALID if unused
+    uint32_t generation;         // Bumped whenever the block is written out
+    tsdb_encoder_t encoder;
+} tsdb_series_t;
+
+// Static variables, guarded by tsdb_lock once mounted
+static const esp_partition_t *partition = NULL;
+static bool mounted = false;
+static uint32_t sector_total = 0;
+static uint32_t head_sector = 0;
+static uint32_t head_seq = 0;
+static uint32_t head_offset = 0;
+static int64_t time_base_s = 0;      // Log time at monotonic zero
+static tsdb_series_t series_slots[TSDB_MAX_SERIES];
+static SemaphoreHandle_t tsdb_lock = NULL;
+static StaticSemaphore_t tsdb_lock_buffer;
+
+static uint32_t blocks_written = 0;
+static uint32_t samples_written = 0;
+static uint32_t sector_erases = 0;
+static uint32_t write_errors = 0;
+
+static inline uint32_t sector_addr(uint32_t sector)
+{
+    return sector * TSDB_SECTOR_SIZE;
+}
+
+static inline uint32_t oldest_seq(void)
+{
+    return head_seq >= sector_total ? head_seq - sector_total + 1 : 1;
+}
+
+// Only valid for oldest_seq() <= seq <= head_seq
+static inline uint32_t sector_of_seq(uint32_t seq)
+{
+    return (head_sector + sector_total - (head_seq - seq)) % sector_total;
+}
+
+static bool sector_read_header(uint32_t sector, uint32_t *seq)
+{
+    tsdb_sector_header_t header;
+    if (esp_partition_read(partition, sector_addr(sector), &header, sizeof(header)) != ESP_OK ||
+        header.magic != TSDB_SECTOR_MAGIC || header.version != TSDB_FORMAT_VERSION ||
+        header.seq == UINT32_MAX) {
+        return false;
+    }
+    *seq = header.seq;
+    return true;
+}
+
+// Erase a sector and make it the head
+static bool sector_start(uint32_t sector, uint32_t seq)
+{
+    esp_err_t err = esp_partition_erase_range(partition, sector_addr(sector), TSDB_SECTOR_SIZE);
+    if (err == ESP_OK) {
+        sector_erases++;
+        tsdb_sector_header_t header = {
+            .magic = TSDB_SECTOR_MAGIC,
+            .seq = seq,
+            .version = TSDB_FORMAT_VERSION,
+        };
+        memset(header.reserved, 0xFF, sizeof(header.reserved));
+        err = esp_partition_write(partition, sector_addr(sector), &header, sizeof(header));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sector %lu: %s", (unsigned long)sector, esp_err_to_name(err));
+        write_errors++;
+        return false;
+    }
+
+    head_sector = sector;
+    head_seq = seq;
+    head_offset = sizeof(tsdb_sector_header_t);
+    return true;
+}
+
+// End of the written area of a sector; raises *last_ts to its newest committed sample
+static uint32_t sector_scan(uint32_t sector, uint32_t *last_ts, bool *found)
+{
+    uint32_t offset = sizeof(tsdb_sector_header_t);
+
+    while (offset + sizeof(tsdb_block_header_t) <= TSDB_SECTOR_SIZE) {
+        tsdb_block_header_t header;
+        if (esp_partition_read(partition, sector_addr(sector) + offset, &header, sizeof(header)) != ESP_OK) {
+            return TSDB_SECTOR_SIZE;
+        }
+        if (header.magic == TSDB_ERASED_MAGIC) {
+            break;
+        }
+        if (header.magic != TSDB_BLOCK_MAGIC || header.payload_len > TSDB_BLOCK_PAYLOAD_MAX ||
+            offset + sizeof(header) + header.payload_len > TSDB_SECTOR_SIZE) {
+            // Damaged; leave the rest of the sector alone
+            return TSDB_SECTOR_SIZE;
+        }
+        if (header.state == TSDB_BLOCK_COMMITTED && (!*found || header.last_ts > *last_ts)) {
+            *last_ts = header.last_ts;
+            *found = true;
+        }
+        offset += sizeof(header) + header.payload_len;
+    }
+    return offset;
+}
+
+static tsdb_series_t *series_slot(uint8_t series, bool create)
+{
+    tsdb_series_t *free_slot = NULL;
+    for (int i = 0; i < TSDB_MAX_SERIES; i++) {
+        if (series_slots[i].series == series) {
+            return &series_slots[i];
+        }
+        if (free_slot == NULL && series_slots[i].series == TSDB_SERIES_INVALID) {
+            free_slot = &series_slots[i];
+        }
+    }
+    if (!create || free_slot == NULL) {
+        return NULL;
+    }
+    free_slot->series = series;
+    tsdb_encoder_reset(&free_slot->encoder);
+    return free_slot;
+}
+
+// Write out a series' open block and start a new one. Called with tsdb_lock held.
+static bool block_write(tsdb_series_t *slot)
+{
+    tsdb_encoder_t *encoder = &slot->encoder;
+    if (encoder->count == 0) {
+        return true;
+    }
+
+    uint32_t size = sizeof(tsdb_block_header_t) + encoder->len;
+    bool written = false;
+
+    // Erasing the next sector recycles the oldest data once the ring is full
+    if (head_offset + size > TSDB_SECTOR_SIZE) {
+        sector_start((head_sector + 1) % sector_total, head_seq + 1);
+    }
+
+    if (head_offset + size <= TSDB_SECTOR_SIZE) {
+        uint32_t addr = sector_addr(head_sector) + head_offset;
+        tsdb_block_header_t header = {
+            .magic = TSDB_BLOCK_MAGIC,
+            .state = 0xFF,
+            .series = slot->series,
+            .count = encoder->count,
+            .payload_len = encoder->len,
+            .first_ts = encoder->first_ts,
+            .last_ts = encoder->last_ts,
+        };
+        const uint8_t commit = TSDB_BLOCK_COMMITTED;
+
+        // Space is consumed even if a write fails; the block is then skipped
+        head_offset += size;
+        esp_err_t err = esp_partition_write(partition, addr, &header, sizeof(header));
+        if (err == ESP_OK) {
+            err = esp_partition_write(partition, addr + sizeof(header), encoder->data, encoder->len);
+        }
+        if (err == ESP_OK) {
+            err = esp_partition_write(partition, addr + offsetof(tsdb_block_header_t, state), &commit, 1);
+        }
+        if (err == ESP_OK) {
+            blocks_written++;
+            written = true;
+        } else {
+            ESP_LOGE(TAG, "Failed to write block of series %d: %s", slot->series, esp_err_to_name(err));
+            write_errors++;
+        }
+    }
+
+    if (!written) {
+        ESP_LOGW(TAG, "Dropped %d samples of series %d", encoder->count, slot->series);
+    }
+    tsdb_encoder_reset(encoder);
+    slot->generation++;
+    return written;
+}
+
+bool tsdb_init(void)
+{
+    if (mounted) {
+        return true;
+    }
+
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                         TSDB_PARTITION_LABEL);
+    if (partition == NULL) {
+        ESP_LOGW(TAG, "No %s partition, sensor log disabled", TSDB_PARTITION_LABEL);
+        return false;
+    }
+
+    sector_total = partition->size / TSDB_SECTOR_SIZE;
+    if (sector_total < 2) {
+        ESP_LOGE(TAG, "Partition %s too small (%lu bytes)", TSDB_PARTITION_LABEL,
+                 (unsigned long)partition->size);
+        return false;
+    }
+
+    // The head is the sector with the highest sequence number
+    bool has_sector = false;
+    for (uint32_t sector = 0; sector < sector_total; sector++) {
+        uint32_t seq;
+        if (sector_read_header(sector, &seq) && (!has_sector || seq > head_seq)) {
+            head_sector = sector;
+            head_seq = seq;
+            has_sector = true;
+        }
+    }
+
+    uint32_t last_ts = 0;
+    bool has_samples = false;
+    if (!has_sector) {
+        ESP_LOGI(TAG, "Formatting %s partition", TSDB_PARTITION_LABEL);
+        if (!sector_start(0, 1)) {
+            return false;
+        }
+    } else {
+        head_offset = sector_scan(head_sector, &last_ts, &has_samples);
+        if (!has_samples && head_seq > oldest_seq()) {
+            uint32_t previous = sector_of_seq(head_seq - 1);
+            uint32_t seq;
+            if (sector_read_header(previous, &seq) && seq == head_seq - 1) {
+                sector_scan(previous, &last_ts, &has_samples);
+            }
+        }
+    }
+
+    // Continue the log time where the previous boot left off
+    time_base_s = has_samples ? (int64_t)last_ts + 1 - timing_monotonic_us() / 1000000 : 0;
+
+    for (int i = 0; i < TSDB_MAX_SERIES; i++) {
+        series_slots[i].series = TSDB_SERIES_INVALID;
+    }
+    tsdb_lock = xSemaphoreCreateMutexStatic(&tsdb_lock_buffer);
+    app_resources_register_static("tsdb", sizeof(series_slots));
+    mounted = true;
+
+    ESP_LOGI(TAG, "Mounted %s: %lu sectors, head sequence %lu, log time %lu s",
+             TSDB_PARTITION_LABEL, (unsigned long)sector_total, (unsigned long)head_seq,
+             (unsigned long)tsdb_log_time_s(timing_monotonic_us()));
+    return true;
+}
+
+uint32_t tsdb_log_time_s(int64_t monotonic_us)
+{
+    int64_t log_time_s = time_base_s + monotonic_us / 1000000;
+    return log_time_s < 0 ? 0 : (uint32_t)log_time_s;
+}
+
+bool tsdb_append(uint8_t series, int64_t monotonic_us, int32_t value)
+{
+    if (!mounted || series == TSDB_SERIES_INVALID) {
+        return false;
+    }
+
+    uint32_t ts = tsdb_log_time_s(monotonic_us);
+    bool stored = false;
+
+    xSemaphoreTake(tsdb_lock, portMAX_DELAY);
+    tsdb_series_t *slot = series_slot(series, true);
+    if (slot != NULL) {
+        tsdb_encoder_t *encoder = &slot->encoder;
+        if (encoder->count > 0 && ts > encoder->first_ts && ts - encoder->first_ts >= TSDB_FLUSH_INTERVAL_S) {
+            block_write(slot);
+        }
+        stored = tsdb_encoder_add(encoder, ts, value);
+        if (!stored) {
+            block_write(slot);
+            stored = tsdb_encoder_add(encoder, ts, value);
+        }
+        if (stored) {
+            samples_written++;
+        }
+    }
+    xSemaphoreGive(tsdb_lock);
+
+    if (slot == NULL) {
+        ESP_LOGW(TAG, "Maximum number of series reached (%d)", TSDB_MAX_SERIES);
+    }
+    return stored;
+}
+
+bool tsdb_flush(void)
+{
+    if (!mounted) {
+        return false;
+    }
+
+    bool ok = true;
+    xSemaphoreTake(tsdb_lock, portMAX_DELAY);
+    for (int i = 0; i < TSDB_MAX_SERIES; i++) {
+        if (series_slots[i].series != TSDB_SERIES_INVALID) {
+            ok &= block_write(&series_slots[i]);
+        }
+    }
+    xSemaphoreGive(tsdb_lock);
+    return ok;
+}
+
+bool tsdb_get_stats(tsdb_stats_t *stats)
+{
+    if (!mounted || stats == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(tsdb_lock, portMAX_DELAY);
+    *stats = (tsdb_stats_t) {
+        .sectors = sector_total,
+        .head_seq = head_seq,
+        .oldest_seq = oldest_seq(),
+        .head_used = head_offset,
+        .blocks_written = blocks_written,
+        .samples_written = samples_written,
+        .sector_erases = sector_erases,
+        .write_errors = write_errors,
+    };
+    xSemaphoreGive(tsdb_lock);
+
+    stats->log_time_s = tsdb_log_time_s(timing_monotonic_us());
+    return true;
+}
+
+/*
+ * Cursors
+ *
+ * A cursor walks sectors from the oldest sequence to the head, skipping
+ * block headers of other series or outside the range, and decodes matching
+ * payloads through a TSDB_CURSOR_CHUNK buffer. It then finishes with the
+ * series' open block in RAM. Each step runs under tsdb_lock; a sector
+ * recycled between steps is detected from its sequence and skipped.
+ */
+
+static bool cursor_read_flash(void *ctx, uint8_t *byte)
+{
+    tsdb_cursor_t *cursor = ctx;
+    if (cursor->chunk_pos == cursor->chunk_len) {
+        if (cursor->read_addr >= cursor->read_end) {
+            return false;
+        }
+        uint32_t len = cursor->read_end - cursor->read_addr;
+        if (len > TSDB_CURSOR_CHUNK) {
+            len = TSDB_CURSOR_CHUNK;
+        }
+        if (esp_partition_read(partition, cursor->read_addr, cursor->chunk, len) != ESP_OK) {
+            return false;
+        }
+        cursor->read_addr += len;
+        cursor->chunk_len = (uint8_t)len;
+        cursor->chunk_pos = 0;
+    }
+    *byte = cursor->chunk[cursor->chunk_pos++];
+    return true;
+}
+
+static bool cursor_read_open_block(void *ctx, uint8_t *byte)
+{
+    tsdb_cursor_t *cursor = ctx;
+    tsdb_series_t *slot = series_slot(cursor->series, false);
+    if (slot == NULL || cursor->open_pos >= slot->encoder.len) {
+        return false;
+    }
+    *byte = slot->encoder.data[cursor->open_pos++];
+    return true;
+}
+
+// Start decoding the next matching block; false once the cursor is done
+static bool cursor_next_block(tsdb_cursor_t *cursor)
+{
+    while (!cursor->done) {
+        if (cursor->seq > head_seq) {
+            // Flash exhausted, finish with the open block
+            tsdb_series_t *slot = series_slot(cursor->series, false);
+            if (slot == NULL || slot->encoder.count == 0 ||
+                slot->encoder.last_ts < cursor->from_s || slot->encoder.first_ts > cursor->to_s) {
+                break;
+            }
+            tsdb_decoder_init(&cursor->decoder, slot->encoder.first_ts, slot->encoder.count);
+            cursor->open_generation = slot->generation;
+            cursor->open_pos = 0;
+            cursor->in_open_block = true;
+            return true;
+        }
+
+        uint32_t sector = sector_of_seq(cursor->seq);
+        if (cursor->offset == 0) {
+            uint32_t seq;
+            if (!sector_read_header(sector, &seq) || seq != cursor->seq) {
+                cursor->seq++;
+                continue;
+            }
+            cursor->offset = sizeof(tsdb_sector_header_t);
+        }
+
+        tsdb_block_header_t header;
+        uint32_t addr = sector_addr(sector) + cursor->offset;
+        if (cursor->offset + sizeof(header) > TSDB_SECTOR_SIZE ||
+            esp_partition_read(partition, addr, &header, sizeof(header)) != ESP_OK ||
+            header.magic != TSDB_BLOCK_MAGIC || header.payload_len > TSDB_BLOCK_PAYLOAD_MAX ||
+            cursor->offset + sizeof(header) + header.payload_len > TSDB_SECTOR_SIZE) {
+            // End of the written area
+            cursor->seq++;
+            cursor->offset = 0;
+            continue;
+        }
+
+        cursor->offset += sizeof(header) + header.payload_len;
+        if (header.state != TSDB_BLOCK_COMMITTED || header.series != cursor->series ||
+            header.last_ts < cursor->from_s) {
+            continue;
+        }
+        if (header.first_ts > cursor->to_s) {
+            break;
+        }
+
+        tsdb_decoder_init(&cursor->decoder, header.first_ts, header.count);
+        cursor->read_addr = addr + sizeof(header);
+        cursor->read_end = cursor->read_addr + header.payload_len;
+        cursor->chunk_len = 0;
+        cursor->chunk_pos = 0;
+        cursor->in_block = true;
+        return true;
+    }
+
+    cursor->done = true;
+    return false;
+}
+
+static bool cursor_step(tsdb_cursor_t *cursor, uint32_t *ts, int32_t *value)
+{
+    while (!cursor->done) {
+        if (!cursor->in_open_block && cursor->seq < oldest_seq()) {
+            // Recycled by the writer since the last step
+            cursor->seq = oldest_seq();
+            cursor->offset = 0;
+            cursor->in_block = false;
+        }
+
+        if (!cursor->in_block && !cursor->in_open_block) {
+            if (!cursor_next_block(cursor)) {
+                break;
+            }
+        }
+
+        bool decoded;
+        if (cursor->in_open_block) {
+            tsdb_series_t *slot = series_slot(cursor->series, false);
+            if (slot == NULL || slot->generation != cursor->open_generation) {
+                // Written out since the cursor passed the head
+                cursor->done = true;
+                break;
+            }
+            decoded = tsdb_decoder_next(&cursor->decoder, cursor_read_open_block, cursor, ts, value);
+            if (!decoded) {
+                cursor->done = true;
+                break;
+            }
+        } else {
+            decoded = tsdb_decoder_next(&cursor->decoder, cursor_read_flash, cursor, ts, value);
+            if (!decoded) {
+                cursor->in_block = false;
+                continue;
+            }
+        }
+
+        if (*ts > cursor->to_s) {
+            cursor->done = true;
+            break;
+        }
+        if (*ts >= cursor->from_s) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool tsdb_cursor_open(tsdb_cursor_t *cursor, uint8_t series, uint32_t from_s, uint32_t to_s)
+{
+    if (!mounted || cursor == NULL || series == TSDB_SERIES_INVALID || from_s > to_s) {
+        return false;
+    }
+
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->series = series;
+    cursor->from_s = from_s;
+    cursor->to_s = to_s;
+
+    xSemaphoreTake(tsdb_lock, portMAX_DELAY);
+    cursor->seq = oldest_seq();
+    xSemaphoreGive(tsdb_lock);
+    return true;
+}
+
+bool tsdb_cursor_next(tsdb_cursor_t *cursor, uint32_t *timestamp_s, int32_t *value)
+{
+    if (!mounted || cursor == NULL || timestamp_s == NULL || value == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(tsdb_lock, portMAX_DELAY);
+    bool found = cursor_step(cursor, timestamp_s, value);
+    xSemaphoreGive(tsdb_lock);
+    return found;
+}
@@ -0,0 +1,78 @@
+/*
+ * On-Flash Time-Series Store
+ *
+ * Append-only log of compressed (timestamp, value) samples on the
+ * "history" data partition. The partition is used as a ring of 4 KB
+ * sectors written in order, so every sector is erased once per pass and
+ * wear is spread evenly; when the ring is full the oldest sector is
+ * recycled. Each series keeps one open block in RAM that is written out
+ * when full or TSDB_FLUSH_INTERVAL_S after its first sample.
+ *
+ * Timestamps are log time: seconds that continue from the newest stored
+ * sample after a reboot, so the log stays ordered without a wall clock.
+ * Time spent powered off does not appear in the log.
+ */
+
+#ifndef TSDB_H
+#define TSDB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tsdb_codec.h"
+
+#define TSDB_PARTITION_LABEL "history"
+#define TSDB_MAX_SERIES 4
+#define TSDB_FLUSH_INTERVAL_S (15 * 60)     // Longest time a sample waits in RAM
+#define TSDB_CURSOR_CHUNK 32                // Flash bytes buffered by a cursor
+
+// Series keys are chosen by the caller; 0xFF is reserved
+#define TSDB_SERIES_INVALID 0xFF
+
+typedef struct {
+    uint32_t sectors;
+    uint32_t head_seq;           // Sequence number of the sector being written
+    uint32_t oldest_seq;         // Oldest sector sequence still on flash
+    uint32_t head_used;          // Bytes used in the head sector
+    uint32_t blocks_written;     // Since boot
+    uint32_t samples_written;
+    uint32_t sector_erases;
+    uint32_t write_errors;
+    uint32_t log_time_s;         // Current log time
+} tsdb_stats_t;
+
+// Streaming range reader. Holds a small flash buffer and the decoder state,
+// never a whole sector; allocate it on the caller's stack.
+typedef struct {
+    uint8_t series;
+    uint32_t from_s;
+    uint32_t to_s;
+    uint32_t seq;                // Sector being read
+    uint32_t offset;             // Next block header in that sector, 0 before its header is checked
+    bool in_block;
+    bool in_open_block;          // Reading the unflushed block in RAM
+    bool done;
+    uint32_t open_generation;
+    uint16_t open_pos;
+    tsdb_decoder_t decoder;
+    uint32_t read_addr;          // Next payload byte to fetch from flash
+    uint32_t read_end;
+    uint8_t chunk[TSDB_CURSOR_CHUNK];
+    uint8_t chunk_len;
+    uint8_t chunk_pos;
+} tsdb_cursor_t;
+
+// Mount the partition, formatting it if it holds no log
+bool tsdb_init(void);
+bool tsdb_append(uint8_t series, int64_t monotonic_us, int32_t value);
+// Write out every open block
+bool tsdb_flush(void);
+uint32_t tsdb_log_time_s(int64_t monotonic_us);
+bool tsdb_get_stats(tsdb_stats_t *stats);
+
+// Samples of a series with from_s <= timestamp <= to_s, oldest first,
+// including those not yet flushed
+bool tsdb_cursor_open(tsdb_cursor_t *cursor, uint8_t series, uint32_t from_s, uint32_t to_s);
+// False at the end of the range
+bool tsdb_cursor_next(tsdb_cursor_t *cursor, uint32_t *timestamp_s, int32_t *value);
+
+#endif // TSDB_H
@@ -0,0 +1,125 @@
+/*
+ * Time-Series Block Codec Implementation
+ */
+
+#include <string.h>
+#include "tsdb_codec.h"
+
+static inline uint32_t zigzag_encode(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t zigzag_decode(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static uint8_t varint_put(uint8_t *out, uint32_t value)
+{
+    uint8_t len = 0;
+    while (value >= 0x80) {
+        out[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+}
+
+static bool varint_get(tsdb_read_byte_t read_byte, void *ctx, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte;
+        if (!read_byte(ctx, &byte)) {
+            return false;
+        }
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void tsdb_encoder_reset(tsdb_encoder_t *encoder)
+{
+    memset(encoder, 0, sizeof(*encoder));
+}
+
+bool tsdb_encoder_add(tsdb_encoder_t *encoder, uint32_t ts, int32_t value)
+{
+    uint8_t sample[TSDB_SAMPLE_BYTES_MAX];
+    uint8_t len = 0;
+    int32_t delta = 0;
+
+    if (encoder->count == 0) {
+        // First timestamp lives in the block header
+        len += varint_put(&sample[len], zigzag_encode(value));
+    } else {
+        if (ts < encoder->last_ts) {
+            ts = encoder->last_ts;
+        }
+        // Deltas wrap modulo 2^32 like the timestamps, so a jump of 2^31 s
+        // or more still round-trips
+        delta = (int32_t)(ts - encoder->last_ts);
+        int32_t delta_of_delta = (int32_t)((uint32_t)delta - (uint32_t)encoder->last_delta);
+        len += varint_put(&sample[len], zigzag_encode(delta_of_delta));
+        len += varint_put(&sample[len], (uint32_t)value ^ (uint32_t)encoder->last_value);
+    }
+
+    if (encoder->len + len > TSDB_BLOCK_PAYLOAD_MAX || encoder->count == UINT16_MAX) {
+        return false;
+    }
+
+    memcpy(&encoder->data[encoder->len], sample, len);
+    encoder->len += len;
+    if (encoder->count == 0) {
+        encoder->first_ts = ts;
+    }
+    encoder->count++;
+    encoder->last_ts = ts;
+    encoder->last_delta = delta;
+    encoder->last_value = value;
+    return true;
+}
+
+void tsdb_decoder_init(tsdb_decoder_t *decoder, uint32_t first_ts, uint16_t count)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->remaining = count;
+    decoder->ts = first_ts;
+}
+
+bool tsdb_decoder_next(tsdb_decoder_t *decoder, tsdb_read_byte_t read_byte, void *ctx,
+                       uint32_t *ts, int32_t *value)
+{
+    if (decoder->remaining == 0) {
+        return false;
+    }
+
+    uint32_t raw;
+    if (!decoder->started) {
+        if (!varint_get(read_byte, ctx, &raw)) {
+            return false;
+        }
+        decoder->value = zigzag_decode(raw);
+        decoder->started = true;
+    } else {
+        if (!varint_get(read_byte, ctx, &raw)) {
+            return false;
+        }
+        decoder->delta = (int32_t)((uint32_t)decoder->delta + (uint32_t)zigzag_decode(raw));
+        decoder->ts += (uint32_t)decoder->delta;
+        if (!varint_get(read_byte, ctx, &raw)) {
+            return false;
+        }
+        decoder->value = (int32_t)((uint32_t)decoder->value ^ raw);
+    }
+
+    decoder->remaining--;
+    *ts = decoder->ts;
+    *value = decoder->value;
+    return true;
+}
@@ -0,0 +1,52 @@
+/*
+ * Time-Series Block Codec
+ *
+ * Compresses (timestamp, value) samples of one series into a byte block:
+ * timestamps as zigzag varints of their delta-of-delta, values as varints
+ * of their XOR with the previous value. Regularly sampled, slowly changing
+ * series cost 2-3 bytes per sample. Decoding is streaming, one byte at a
+ * time, so a block never has to be held in RAM to be read.
+ * Has no ESP-IDF dependencies.
+ */
+
+#ifndef TSDB_CODEC_H
+#define TSDB_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TSDB_BLOCK_PAYLOAD_MAX 240
+#define TSDB_SAMPLE_BYTES_MAX 10    // Two 5-byte varints
+
+typedef struct {
+    uint8_t data[TSDB_BLOCK_PAYLOAD_MAX];
+    uint16_t len;
+    uint16_t count;
+    uint32_t first_ts;
+    uint32_t last_ts;
+    int32_t last_delta;
+    int32_t last_value;
+} tsdb_encoder_t;
+
+typedef struct {
+    uint16_t remaining;          // Samples left in the block
+    bool started;
+    uint32_t ts;
+    int32_t delta;
+    int32_t value;
+} tsdb_decoder_t;
+
+// Supplies the next payload byte; false at the end of the data
+typedef bool (*tsdb_read_byte_t)(void *ctx, uint8_t *byte);
+
+void tsdb_encoder_reset(tsdb_encoder_t *encoder);
+// False if the sample does not fit; write the block out and reset first.
+// Timestamps must not decrease.
+bool tsdb_encoder_add(tsdb_encoder_t *encoder, uint32_t ts, int32_t value);
+
+void tsdb_decoder_init(tsdb_decoder_t *decoder, uint32_t first_ts, uint16_t count);
+// False when the block is exhausted or truncated
+bool tsdb_decoder_next(tsdb_decoder_t *decoder, tsdb_read_byte_t read_byte, void *ctx,
+                       uint32_t *ts, int32_t *value);
+
+#endif // TSDB_CODEC_H
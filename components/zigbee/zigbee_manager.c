@@ -14,6 +14,7 @@
 #include "zigbee_manager.h"
 #include "sensor_manager.h"
 #include "light_control.h"
+#include "app_resources.h"
 
 #if !defined ZB_ED_ROLE
 #error Define ZB_ED_ROLE in idf.py menuconfig to compile light (End Device) source code.
@@ -117,15 +118,13 @@ static void sensor_update_callback(const sensor_reading_t *reading)
         return;
     }
 
-    // Convert temperature to Zigbee format (0.01°C resolution, signed)
-    int16_t temp_zb = (int16_t)(reading->data.env.temperature_c * 100);
-
-    // Convert humidity to Zigbee format (0.01% resolution, unsigned)
-    uint16_t humidity_zb = (uint16_t)(reading->data.env.humidity_percent * 100);
+    // Sensor values are already in Zigbee units (0.01°C signed, 0.01% unsigned)
+    int16_t temp_zb = reading->data.env.temperature_centi_c;
+    uint16_t humidity_zb = reading->data.env.humidity_centi_pct;
 
     ESP_LOGI(TAG, "Updating Zigbee sensor values: Temp=%.2f°C (%d), Humidity=%.2f%% (%d)",
-            reading->data.env.temperature_c, temp_zb,
-            reading->data.env.humidity_percent, humidity_zb);
+            temp_zb / 100.0f, temp_zb,
+            humidity_zb / 100.0f, humidity_zb);
 
     // Update temperature measurement cluster
     esp_zb_lock_acquire(portMAX_DELAY);
@@ -229,12 +228,81 @@ static void esp_zb_task(void *pvParameters)
         // Register callback for sensor updates
         sensor_manager_register_callback(sensor_update_callback);
 
-        // Start periodic sensor updates (60 seconds)
+        // Keep windowed min/max/mean for the environmental sensor, and a 1-minute log on flash
+        sensor_id_t env_sensor = sensor_find(SENSOR_TYPE_ENVIRONMENTAL);
+        sensor_manager_enable_log(env_sensor, SENSOR_CHANNEL_TEMPERATURE);
+        sensor_manager_enable_log(env_sensor, SENSOR_CHANNEL_HUMIDITY);
+
+        // Drop single-sample DHT22 spikes and implausible jumps before they reach the network
+        sensor_filter_config_t temperature_filter = {
+            .stages = {
+                { .type = SENSOR_FILTER_MEDIAN, .median = { .window = 3 } },
+                { .type = SENSOR_FILTER_RATE_LIMIT, .rate = { .max_per_s = 10, .max_rejects = 3 } },  // 0.1 °C/s
+            },
+            .num_stages = 2,
+        };
+        sensor_filter_config_t humidity_filter = {
+            .stages = {
+                { .type = SENSOR_FILTER_MEDIAN, .median = { .window = 3 } },
+                { .type = SENSOR_FILTER_RATE_LIMIT, .rate = { .max_per_s = 50, .max_rejects = 3 } },  // 0.5 %RH/s
+            },
+            .num_stages = 2,
+        };
+        sensor_manager_set_filter(env_sensor, SENSOR_CHANNEL_TEMPERATURE, &temperature_filter);
+        sensor_manager_set_filter(env_sensor, SENSOR_CHANNEL_HUMIDITY, &humidity_filter);
+
+        // Only write the attributes when a value moves, with a heartbeat every 10 minutes
+        sensor_publish_config_t publish_config = {
+            .deadband = {
+                [SENSOR_CHANNEL_TEMPERATURE] = 10,    // 0.1 °C
+                [SENSOR_CHANNEL_HUMIDITY] = 50,       // 0.5 %RH
+            },
+            .max_interval_ms = 10 * 60 * 1000,
+        };
+        sensor_manager_set_publish_config(env_sensor, &publish_config);
+
+        // Environment every 60 seconds; door position at 10 Hz, published when it moves 2 cm
+        sensor_manager_schedule(env_sensor, 60 * 1000, 5 * 1000);
+        sensor_id_t depth_sensor = sensor_find(SENSOR_TYPE_DEPTH);
+        if (depth_sensor != SENSOR_ID_INVALID) {
+            sensor_publish_config_t depth_publish_config = {
+                .deadband = {
+                    [SENSOR_CHANNEL_DISTANCE] = 20,       // mm
+                },
+                .max_interval_ms = 10 * 60 * 1000,
+            };
+            sensor_manager_set_publish_config(depth_sensor, &depth_publish_config);
+            // Each read is a single ping; drop lone reflections
+            sensor_filter_config_t distance_filter = {
+                .stages = {
+                    { .type = SENSOR_FILTER_MEDIAN, .median = { .window = 3 } },
+                },
+                .num_stages = 1,
+            };
+            sensor_manager_set_filter(depth_sensor, SENSOR_CHANNEL_DISTANCE, &distance_filter);
+            sensor_manager_schedule(depth_sensor, 100, 0);
+        }
+
+        // Start periodic sensor updates
         if (!sensor_manager_start_updates(60 * 1000)) {
             ESP_LOGE(TAG, "Failed to start sensor updates");
         }
+
+        // Sample faster while temperature or humidity is moving, slower at rest
+        sensor_adaptive_config_t adaptive_config = {
+            .min_period_ms = 10 * 1000,
+            .max_period_ms = 5 * 60 * 1000,
+            .activity_threshold = {
+                [SENSOR_CHANNEL_TEMPERATURE] = 20,    // 0.2 °C
+                [SENSOR_CHANNEL_HUMIDITY] = 100,      // 1 %RH
+            },
+        };
+        sensor_manager_set_adaptive(env_sensor, &adaptive_config);
     }
 
+    // Every application task and queue exists by now
+    app_resources_report();
+
     esp_zb_stack_main_loop();
 }
 
@@ -245,5 +313,9 @@ void zigbee_manager_init(void)
         .host_config = ESP_ZB_DEFAULT_HOST_CONFIG(),
     };
     ESP_ERROR_CHECK(esp_zb_platform_config(&config));
-    xTaskCreate(esp_zb_task, "Zigbee_main", 4096, NULL, 5, NULL);
+    static StaticTask_t zigbee_task_buffer;
+    static StackType_t zigbee_task_stack[APP_ZIGBEE_TASK_STACK_SIZE];
+    TaskHandle_t zigbee_task = xTaskCreateStatic(esp_zb_task, "Zigbee_main", APP_ZIGBEE_TASK_STACK_SIZE, NULL,
+                                                 APP_ZIGBEE_TASK_PRIORITY, zigbee_task_stack, &zigbee_task_buffer);
+    app_resources_register_task(zigbee_task, APP_ZIGBEE_TASK_STACK_SIZE);
 }
@@ -0,0 +1,46 @@
+/*
+ * DHT22 Decoder Benchmark
+ *
+ * Per-frame decode cost over a mix of clean, jittered and failing traces.
+ * Usage: bench_dht22_decode [iterations]
+ */
+
+#include <stdlib.h>
+#include "test_harness.h"
+#include "dht22_traces.h"
+
+#define BENCH_TRACES 64
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    static dht22_trace_t traces[BENCH_TRACES];
+
+    for (int i = 0; i < BENCH_TRACES; i++) {
+        uint8_t data[DHT22_DATA_BYTES];
+        dht22_trace_timing_t timing = (i % 4 == 3) ? dht22_timing_slow_edges : dht22_timing_nominal;
+        timing.jitter_us = (uint16_t)(i % 4 == 0 ? 0 : 8);
+        timing.seed = (uint32_t)i + 1;
+        dht22_trace_bytes((uint16_t)(i * 15), (int16_t)(i * 11 - 200), data);
+        if (i % 16 == 5) {
+            data[4] ^= 0x40;
+        }
+        dht22_trace_build(data, &timing, &traces[i]);
+    }
+
+    long ok = 0;
+    uint64_t start = bench_now_ns();
+    for (long n = 0; n < iterations; n++) {
+        const dht22_trace_t *trace = &traces[n % BENCH_TRACES];
+        dht22_frame_t frame;
+        if (dht22_decode_edges(trace->edges_us, trace->num_edges, trace->first_level, &frame) ==
+            DHT22_DECODE_OK) {
+            ok++;
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    printf("dht22_decode_edges: %ld frames, %.1f ns/frame, %ld decoded\n", iterations,
+           iterations ? (double)elapsed / (double)iterations : 0.0, ok);
+    return 0;
+}
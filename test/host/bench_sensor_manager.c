@@ -0,0 +1,281 @@
+/*
+ * Sensor Manager Benchmark
+ *
+ * Runs the unmodified sensor manager on the FreeRTOS host shim with mock
+ * drivers whose asynchronous reads complete from a driver thread, as the
+ * esp_timer task does on target. Reports sampling throughput, sample to
+ * callback latency percentiles, queue high-water marks and the static
+ * memory registered with app_resources.
+ * Usage: bench_sensor_manager [sensors] [rate Hz per sensor] [seconds] [read us]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test_harness.h"
+#include "sensor_manager.h"
+#include "sensor_dht22.h"
+#include "sensor_hcsr04.h"
+#include "app_resources.h"
+#include "timing.h"
+
+#define BENCH_DEFAULT_READ_US 2000       // Mock conversion time, a DHT22 transaction is ~5 ms
+#define BENCH_SUBSCRIBER_DEPTH 4         // Depth of sensor_manager_register_callback()
+
+// A mock sensor instance; at most one read is in flight, as the interface guarantees
+typedef struct {
+    int index;
+    bool pending;
+    uint64_t due_ns;
+    sensor_driver_done_t done;
+    void *done_ctx;
+    int32_t value;
+} mock_sensor_t;
+
+static mock_sensor_t mocks[SENSOR_MAX_INSTANCES];
+static int mock_count;
+static int mock_registered;
+static uint32_t read_us;
+static uint32_t rng_state = 0x2545F491;
+static pthread_mutex_t driver_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t driver_wake = PTHREAD_COND_INITIALIZER;
+
+// Sample to callback latency of every delivered reading
+static uint32_t *latencies;
+static uint32_t latency_capacity;
+static uint32_t latency_count;
+
+static uint32_t bench_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static bool mock_read(void *ctx, sensor_reading_t *reading)
+{
+    mock_sensor_t *mock = ctx;
+    mock->value += (int32_t)(bench_random() % 21) - 10;
+    reading->data.env.temperature_centi_c = (int16_t)(2000 + mock->value % 500);
+    reading->data.env.humidity_centi_pct = 5000;
+    reading->valid = true;
+    return true;
+}
+
+static bool mock_read_async(void *ctx, sensor_driver_done_t done, void *done_ctx)
+{
+    mock_sensor_t *mock = ctx;
+
+    pthread_mutex_lock(&driver_lock);
+    mock->pending = true;
+    mock->due_ns = bench_now_ns() + (uint64_t)read_us * 1000;
+    mock->done = done;
+    mock->done_ctx = done_ctx;
+    pthread_cond_signal(&driver_wake);
+    pthread_mutex_unlock(&driver_lock);
+    return true;
+}
+
+static const sensor_driver_t mock_env_driver = {
+    .name = "mock_env",
+    .type = SENSOR_TYPE_ENVIRONMENTAL,
+    .read = mock_read,
+    .read_async = mock_read_async,
+};
+
+// Completes reads in due order, one thread for all sensors
+static void *driver_thread(void *arg)
+{
+    pthread_mutex_lock(&driver_lock);
+    while (true) {
+        mock_sensor_t *next = NULL;
+        for (int i = 0; i < mock_count; i++) {
+            if (mocks[i].pending && (next == NULL || mocks[i].due_ns < next->due_ns)) {
+                next = &mocks[i];
+            }
+        }
+        if (next == NULL) {
+            pthread_cond_wait(&driver_wake, &driver_lock);
+            continue;
+        }
+
+        uint64_t now = bench_now_ns();
+        if (now < next->due_ns) {
+            struct timespec wait = {
+                .tv_sec = (time_t)((next->due_ns - now) / 1000000000ULL),
+                .tv_nsec = (long)((next->due_ns - now) % 1000000000ULL),
+            };
+            pthread_mutex_unlock(&driver_lock);
+            nanosleep(&wait, NULL);
+            pthread_mutex_lock(&driver_lock);
+            continue;
+        }
+
+        next->pending = false;
+        sensor_reading_t reading = { .valid = false };
+        mock_read(next, &reading);
+        sensor_driver_done_t done = next->done;
+        void *done_ctx = next->done_ctx;
+        pthread_mutex_unlock(&driver_lock);
+        done(done_ctx, &reading);
+        pthread_mutex_lock(&driver_lock);
+    }
+    return NULL;
+}
+
+static bool mock_register(sensor_id_t *ret_id)
+{
+    if (mock_registered >= mock_count) {
+        return false;
+    }
+    mock_sensor_t *mock = &mocks[mock_registered];
+    mock->index = mock_registered;
+    if (!sensor_register(&mock_env_driver, mock, ret_id)) {
+        return false;
+    }
+    mock_registered++;
+    return true;
+}
+
+// Board sensors of sensor_init(), replaced by mocks
+bool sensor_dht22_register(int gpio_pin, sensor_id_t *ret_id)
+{
+    return mock_register(ret_id);
+}
+
+bool sensor_hcsr04_register(int trigger_pin, int echo_pin, sensor_id_t *ret_id)
+{
+    return mock_register(ret_id);
+}
+
+static void bench_callback(const sensor_reading_t *reading)
+{
+    int64_t latency_us = timing_monotonic_us() - reading->sampled_at_us;
+    uint32_t n = __atomic_load_n(&latency_count, __ATOMIC_RELAXED);
+    if (n < latency_capacity) {
+        latencies[n] = latency_us < 0 ? 0 : (uint32_t)latency_us;
+        __atomic_store_n(&latency_count, n + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, uint32_t count, uint32_t percent)
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t rank = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+int main(int argc, char **argv)
+{
+    mock_count = argc > 1 ? atoi(argv[1]) : 4;
+    int rate_hz = argc > 2 ? atoi(argv[2]) : 10;
+    double seconds = argc > 3 ? atof(argv[3]) : 5.0;
+    read_us = argc > 4 ? (uint32_t)atoi(argv[4]) : BENCH_DEFAULT_READ_US;
+    if (mock_count < 1 || mock_count > SENSOR_MAX_INSTANCES || mock_count > SENSOR_MANAGER_MAX_SCHEDULES) {
+        mock_count = 4;
+    }
+    if (rate_hz < 1 || rate_hz > 1000) {
+        rate_hz = 10;
+    }
+    if (seconds <= 0) {
+        seconds = 5.0;
+    }
+    uint32_t period_ms = 1000 / (uint32_t)rate_hz;
+
+    latency_capacity = (uint32_t)(seconds * mock_count * rate_hz * 2) + 1024;
+    latencies = calloc(latency_capacity, sizeof(*latencies));
+    if (latencies == NULL) {
+        return 1;
+    }
+
+    pthread_t driver;
+    pthread_create(&driver, NULL, driver_thread, NULL);
+
+    if (!sensor_manager_init()) {
+        fprintf(stderr, "sensor_manager_init failed\n");
+        return 1;
+    }
+    // sensor_init() registered the first mocks in place of the board sensors
+    sensor_id_t id;
+    while (mock_registered < mock_count && mock_register(&id)) {
+    }
+    sensor_subscriber_config_t subscriber = {
+        .callback = bench_callback,
+        .name = "bench_sub",
+        .queue_depth = BENCH_SUBSCRIBER_DEPTH,
+        .policy = SENSOR_QUEUE_COALESCE,
+    };
+    if (!sensor_manager_subscribe(&subscriber, NULL)) {
+        return 1;
+    }
+    // Spread phases over one period, as staggered schedules on target
+    for (int i = 0; i < mock_count; i++) {
+        sensor_manager_schedule((sensor_id_t)i, period_ms, period_ms * (uint32_t)i / (uint32_t)mock_count);
+    }
+
+    printf("%d sensors at %d Hz (every %u ms), %u us reads, %.1f s\n", mock_count, rate_hz,
+           (unsigned)period_ms, (unsigned)read_us, seconds);
+
+    uint64_t start = bench_now_ns();
+    if (!sensor_manager_start_updates(period_ms)) {
+        return 1;
+    }
+    struct timespec run = {
+        .tv_sec = (time_t)seconds,
+        .tv_nsec = (long)((seconds - (double)(time_t)seconds) * 1e9),
+    };
+    nanosleep(&run, NULL);
+    sensor_manager_stop_updates();
+    double elapsed_s = (double)(bench_now_ns() - start) / 1e9;
+    // Let the subscriber drain what the last reads published
+    struct timespec drain = { .tv_nsec = 50 * 1000000L };
+    nanosleep(&drain, NULL);
+
+    sensor_manager_status_t status;
+    sensor_manager_get_status(&status);
+    sensor_subscriber_stats_t sub;
+    sensor_manager_get_subscriber_stats(0, &sub);
+
+    // Publish latency of all sensors in one histogram
+    sensor_latency_t publish = { 0 };
+    for (int i = 0; i < mock_count; i++) {
+        sensor_latency_t latency;
+        if (sensor_manager_get_publish_latency((sensor_id_t)i, &latency)) {
+            publish.count += latency.count;
+            publish.max_us = latency.max_us > publish.max_us ? latency.max_us : publish.max_us;
+            for (int b = 0; b < SENSOR_LATENCY_BUCKETS; b++) {
+                publish.histogram[b] += latency.histogram[b];
+            }
+        }
+    }
+
+    uint32_t count = __atomic_load_n(&latency_count, __ATOMIC_ACQUIRE);
+    qsort(latencies, count, sizeof(*latencies), compare_u32);
+
+    printf("samples/s        %9.1f (target %d), %u readings, %u failed, %u deadlines skipped\n",
+           (double)status.readings / elapsed_s, mock_count * rate_hz, (unsigned)status.readings,
+           (unsigned)status.read_failures, (unsigned)status.deadlines_skipped);
+    printf("callback latency p50 %u us, p99 %u us, max %u us (%u delivered)\n",
+           (unsigned)percentile(latencies, count, 50), (unsigned)percentile(latencies, count, 99),
+           count ? (unsigned)latencies[count - 1] : 0, (unsigned)count);
+    printf("publish latency  p50 <= %u us, p99 <= %u us, max %u us (%u published)\n",
+           (unsigned)sensor_latency_percentile(&publish, 50), (unsigned)sensor_latency_percentile(&publish, 99),
+           (unsigned)publish.max_us, (unsigned)publish.count);
+    printf("queue peak       events %u/%u, subscriber %u/%u (%u dropped, %u coalesced)\n",
+           (unsigned)status.event_queue_max_depth, (unsigned)APP_SENSOR_EVENT_QUEUE_LEN,
+           (unsigned)sub.max_depth, (unsigned)BENCH_SUBSCRIBER_DEPTH,
+           (unsigned)sub.dropped, (unsigned)sub.coalesced);
+    app_resources_report();
+
+    // A pipeline that delivers nothing is broken, whatever the host load
+    return status.readings > 0 && count > 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+/*
+ * Sensor Snapshot Benchmark
+ *
+ * Cost of reading the latest reading through the latched seqlock versus a
+ * mutex around a single copy, with N reader threads and an optional writer
+ * publishing continuously.
+ * Usage: bench_sensor_snapshot [readers] [reads per reader]
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "test_harness.h"
+#include "sensor_snapshot.h"
+
+typedef enum {
+    BENCH_SEQLOCK,
+    BENCH_MUTEX,
+} bench_mode_t;
+
+static sensor_snapshot_t snapshot;
+static sensor_reading_t locked_reading;
+static pthread_mutex_t locked_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bench_mode_t mode;
+static long reads_per_reader;
+static volatile int stop_writer;
+static volatile int64_t sink;
+
+static void *writer_thread(void *arg)
+{
+    sensor_reading_t reading = { .type = SENSOR_TYPE_ENVIRONMENTAL, .valid = true };
+    while (!__atomic_load_n(&stop_writer, __ATOMIC_ACQUIRE)) {
+        reading.sampled_at_us++;
+        if (mode == BENCH_SEQLOCK) {
+            sensor_snapshot_write(&snapshot, &reading);
+        } else {
+            pthread_mutex_lock(&locked_mutex);
+            locked_reading = reading;
+            pthread_mutex_unlock(&locked_mutex);
+        }
+    }
+    return NULL;
+}
+
+static void *reader_thread(void *arg)
+{
+    int64_t sum = 0;
+    for (long n = 0; n < reads_per_reader; n++) {
+        sensor_reading_t reading;
+        if (mode == BENCH_SEQLOCK) {
+            sensor_snapshot_read(&snapshot, &reading);
+        } else {
+            pthread_mutex_lock(&locked_mutex);
+            reading = locked_reading;
+            pthread_mutex_unlock(&locked_mutex);
+        }
+        sum += reading.sampled_at_us;
+    }
+    sink += sum;
+    return NULL;
+}
+
+static void run(bench_mode_t bench_mode, int num_readers, bool with_writer)
+{
+    pthread_t writer;
+    pthread_t readers[64];
+
+    mode = bench_mode;
+    stop_writer = 0;
+    if (with_writer) {
+        pthread_create(&writer, NULL, writer_thread, NULL);
+    }
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < num_readers; i++) {
+        pthread_create(&readers[i], NULL, reader_thread, NULL);
+    }
+    for (int i = 0; i < num_readers; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    if (with_writer) {
+        __atomic_store_n(&stop_writer, 1, __ATOMIC_RELEASE);
+        pthread_join(writer, NULL);
+    }
+
+    printf("%-8s %2d readers %-10s %7.1f ns/read\n", bench_mode == BENCH_SEQLOCK ? "seqlock" : "mutex",
+           num_readers, with_writer ? "+ writer" : "", (double)elapsed / (double)reads_per_reader);
+}
+
+int main(int argc, char **argv)
+{
+    int num_readers = argc > 1 ? atoi(argv[1]) : 4;
+    reads_per_reader = argc > 2 ? atol(argv[2]) : 5000000;
+    if (num_readers < 1 || num_readers > 64) {
+        num_readers = 4;
+    }
+
+    // Wall time per read on each reader thread, readers running in parallel
+    for (int readers = 1; readers <= num_readers; readers *= 2) {
+        for (int writer = 0; writer <= 1; writer++) {
+            run(BENCH_SEQLOCK, readers, writer);
+            run(BENCH_MUTEX, readers, writer);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * DHT22 Trace Corpus Implementation
+ */
+
+#include <string.h>
+#include "dht22_traces.h"
+
+// Edges before the first data bit: start, release, response low, response high
+#define TRACE_HEADER_EDGES 4
+
+const dht22_trace_timing_t dht22_timing_nominal = {
+    .start_low_us = 1100,
+    .release_us = 30,
+    .response_low_us = 80,
+    .response_high_us = 80,
+    .bit_low_us = 50,
+    .zero_high_us = 26,
+    .one_high_us = 70,
+};
+
+const dht22_trace_timing_t dht22_timing_slow_edges = {
+    .start_low_us = 1100,
+    .release_us = 40,
+    .response_low_us = 70,
+    .response_high_us = 95,
+    .bit_low_us = 38,
+    .zero_high_us = 48,
+    .one_high_us = 92,
+    .jitter_us = 4,
+    .seed = 7,
+};
+
+static uint32_t trace_random(uint32_t *state)
+{
+    // xorshift32; never returns to 0 from a non-zero seed
+    uint32_t x = *state ? *state : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static uint32_t trace_jitter(uint32_t width, const dht22_trace_timing_t *timing, uint32_t *state)
+{
+    if (timing->jitter_us == 0) {
+        return width;
+    }
+    int32_t span = 2 * timing->jitter_us + 1;
+    int32_t offset = (int32_t)(trace_random(state) % (uint32_t)span) - timing->jitter_us;
+    return (uint32_t)((int32_t)width + offset);
+}
+
+void dht22_trace_bytes(uint16_t humidity_deci_pct, int16_t temperature_deci_c, uint8_t data[DHT22_DATA_BYTES])
+{
+    uint16_t raw_temperature = temperature_deci_c < 0 ? (uint16_t)(0x8000 | -temperature_deci_c)
+                                                      : (uint16_t)temperature_deci_c;
+    data[0] = (uint8_t)(humidity_deci_pct >> 8);
+    data[1] = (uint8_t)humidity_deci_pct;
+    data[2] = (uint8_t)(raw_temperature >> 8);
+    data[3] = (uint8_t)raw_temperature;
+    data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+}
+
+void dht22_trace_build(const uint8_t data[DHT22_DATA_BYTES], const dht22_trace_timing_t *timing,
+                       dht22_trace_t *trace)
+{
+    uint32_t state = timing->seed;
+    uint32_t now = 0;
+    size_t count = 0;
+
+    trace->first_level = 0;
+    trace->edges_us[count++] = now;
+    now += timing->start_low_us;
+    trace->edges_us[count++] = now;
+    now += trace_jitter(timing->release_us, timing, &state);
+    trace->edges_us[count++] = now;
+    now += trace_jitter(timing->response_low_us, timing, &state);
+    trace->edges_us[count++] = now;
+    now += trace_jitter(timing->response_high_us, timing, &state);
+    trace->edges_us[count++] = now;
+
+    for (int bit = 0; bit < DHT22_DATA_BITS; bit++) {
+        bool one = data[bit / 8] & (1 << (7 - (bit % 8)));
+        now += trace_jitter(timing->bit_low_us, timing, &state);
+        trace->edges_us[count++] = now;
+        now += trace_jitter(one ? timing->one_high_us : timing->zero_high_us, timing, &state);
+        trace->edges_us[count++] = now;
+    }
+
+    // Trailing low before the line is released to idle
+    now += trace_jitter(timing->bit_low_us, timing, &state);
+    trace->edges_us[count++] = now;
+    trace->num_edges = count;
+}
+
+void dht22_trace_drop_edges(dht22_trace_t *trace, size_t index, size_t count)
+{
+    memmove(&trace->edges_us[index], &trace->edges_us[index + count],
+            (trace->num_edges - index - count) * sizeof(trace->edges_us[0]));
+    trace->num_edges -= count;
+}
+
+void dht22_trace_insert_glitch(dht22_trace_t *trace, size_t index, uint32_t offset_us, uint32_t width_us)
+{
+    uint32_t at = trace->edges_us[index] + offset_us;
+    memmove(&trace->edges_us[index + 3], &trace->edges_us[index + 1],
+            (trace->num_edges - index - 1) * sizeof(trace->edges_us[0]));
+    trace->edges_us[index + 1] = at;
+    trace->edges_us[index + 2] = at + width_us;
+    trace->num_edges += 2;
+}
+
+size_t dht22_trace_bit_edge(int bit)
+{
+    return TRACE_HEADER_EDGES + 2 * (size_t)bit;
+}
@@ -0,0 +1,57 @@
+/*
+ * DHT22 Trace Corpus
+ *
+ * Edge traces in the format the driver hands to dht22_decode_edges():
+ * timestamps of consecutive line transitions starting at 0, with the
+ * level after the first edge. A trace begins with the host start signal
+ * (line held low, then released high) followed by the sensor frame.
+ *
+ * Frames are synthesised from five data bytes and a timing profile, with
+ * deterministic per-pulse jitter, so a failing case reproduces exactly.
+ */
+
+#ifndef DHT22_TRACES_H
+#define DHT22_TRACES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dht22_decode.h"
+
+#define DHT22_TRACE_MAX_EDGES (DHT22_FRAME_EDGES + 16)
+
+// Pulse widths of one frame in microseconds
+typedef struct {
+    uint16_t start_low_us;       // Host start signal
+    uint16_t release_us;         // Host release before the sensor responds
+    uint16_t response_low_us;
+    uint16_t response_high_us;
+    uint16_t bit_low_us;
+    uint16_t zero_high_us;
+    uint16_t one_high_us;
+    uint16_t jitter_us;          // Each pulse is widened or narrowed by up to this much
+    uint32_t seed;               // Jitter sequence
+} dht22_trace_timing_t;
+
+typedef struct {
+    uint32_t edges_us[DHT22_TRACE_MAX_EDGES];
+    size_t num_edges;
+    int first_level;
+} dht22_trace_t;
+
+// Datasheet timing, no jitter
+extern const dht22_trace_timing_t dht22_timing_nominal;
+// Slow edges on a long cable: every high phase stretched, low phases shortened
+extern const dht22_trace_timing_t dht22_timing_slow_edges;
+
+// Raw bytes for humidity and temperature in 0.1 units, with a valid checksum
+void dht22_trace_bytes(uint16_t humidity_deci_pct, int16_t temperature_deci_c, uint8_t data[DHT22_DATA_BYTES]);
+void dht22_trace_build(const uint8_t data[DHT22_DATA_BYTES], const dht22_trace_timing_t *timing,
+                       dht22_trace_t *trace);
+// Remove 'count' edges starting at 'index', merging the pulses around them
+void dht22_trace_drop_edges(dht22_trace_t *trace, size_t index, size_t count);
+// Split the pulse starting at edge 'index' with a glitch of 'width_us' at 'offset_us'
+void dht22_trace_insert_glitch(dht22_trace_t *trace, size_t index, uint32_t offset_us, uint32_t width_us);
+// Edge index where the given data bit's low phase starts
+size_t dht22_trace_bit_edge(int bit);
+
+#endif // DHT22_TRACES_H
@@ -0,0 +1,100 @@
+/*
+ * Application Resource Registry Host Shim
+ *
+ * Same registry as on target, reported on stdout with host-safe formats.
+ * Sizes are the firmware's configured stacks and buffers; the process peak
+ * RSS is printed alongside for the host's own footprint.
+ */
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include "app_resources.h"
+
+typedef struct {
+    const char *kind;
+    const char *name;
+    uint32_t size;
+    QueueHandle_t queue;
+    uint32_t length;
+} app_resource_t;
+
+static app_resource_t resources[APP_RESOURCES_MAX];
+static uint8_t resource_count = 0;
+static portMUX_TYPE resource_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool app_resources_add(const app_resource_t *resource)
+{
+    bool added = false;
+
+    portENTER_CRITICAL(&resource_lock);
+    if (resource_count < APP_RESOURCES_MAX) {
+        resources[resource_count++] = *resource;
+        added = true;
+    }
+    portEXIT_CRITICAL(&resource_lock);
+    return added;
+}
+
+bool app_resources_register_task(TaskHandle_t task, uint32_t stack_size)
+{
+    if (task == NULL) {
+        return false;
+    }
+
+    app_resource_t resource = {
+        .kind = "task",
+        .name = pcTaskGetName(task),
+        .size = stack_size,
+    };
+    return app_resources_add(&resource);
+}
+
+bool app_resources_register_queue(const char *name, QueueHandle_t queue, uint32_t length, uint32_t item_size)
+{
+    if (queue == NULL) {
+        return false;
+    }
+
+    app_resource_t resource = {
+        .kind = "queue",
+        .name = name,
+        .size = length * item_size,
+        .queue = queue,
+        .length = length,
+    };
+    return app_resources_add(&resource);
+}
+
+bool app_resources_register_static(const char *name, uint32_t size)
+{
+    app_resource_t resource = {
+        .kind = "data",
+        .name = name,
+        .size = size,
+    };
+    return app_resources_add(&resource);
+}
+
+void app_resources_report(void)
+{
+    uint32_t total = 0;
+
+    portENTER_CRITICAL(&resource_lock);
+    uint8_t count = resource_count;
+    portEXIT_CRITICAL(&resource_lock);
+
+    printf("static allocations:\n");
+    for (uint8_t i = 0; i < count; i++) {
+        const app_resource_t *resource = &resources[i];
+        total += resource->size;
+        printf("  %-5s %-16s %6u B", resource->kind, resource->name, (unsigned)resource->size);
+        if (resource->queue) {
+            printf(", %u/%u queued", (unsigned)uxQueueMessagesWaiting(resource->queue), (unsigned)resource->length);
+        }
+        printf("\n");
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("  total %u B static; host peak RSS %ld KB\n", (unsigned)total, usage.ru_maxrss);
+}
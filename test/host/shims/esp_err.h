@@ -0,0 +1,16 @@
+/*
+ * ESP Error Codes Host Shim
+ */
+
+#ifndef ESP_ERR_H
+#define ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NOT_SUPPORTED 0x106
+
+const char *esp_err_to_name(esp_err_t code);
+
+#endif // ESP_ERR_H
@@ -0,0 +1,15 @@
+/*
+ * ESP Timer Host Shim
+ *
+ * Microseconds on CLOCK_MONOTONIC, the same clock as the host timing
+ * backend, so esp_timer and timing_monotonic_us() timestamps compare.
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif // ESP_TIMER_H
@@ -0,0 +1,41 @@
+/*
+ * FreeRTOS Host Shim
+ *
+ * The subset of the FreeRTOS API used by the sensor pipeline, on POSIX
+ * threads. Tasks are threads, critical sections are recursive mutexes and
+ * blocking calls wait on condition variables against CLOCK_MONOTONIC, so
+ * firmware sources build and run unchanged on Linux. Scheduling priorities
+ * and stack sizes are not modelled.
+ */
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define configTICK_RATE_HZ 100               // ESP-IDF default (CONFIG_FREERTOS_HZ)
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t;                 // ESP-IDF counts stacks in bytes
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)UINT32_MAX)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+// Critical sections nest, as they do on target
+typedef struct {
+    pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+#define portENTER_CRITICAL(mux) pthread_mutex_lock(&(mux)->mutex)
+#define portEXIT_CRITICAL(mux) pthread_mutex_unlock(&(mux)->mutex)
+
+#endif // FREERTOS_H
@@ -0,0 +1,32 @@
+/*
+ * FreeRTOS Queue Host Shim
+ *
+ * Fixed-size item rings in caller-provided storage, as with
+ * xQueueCreateStatic() on target.
+ */
+
+#ifndef FREERTOS_QUEUE_H
+#define FREERTOS_QUEUE_H
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;      // An item was added or removed
+    uint8_t *storage;
+    size_t item_size;
+    UBaseType_t length;
+    UBaseType_t head;
+    UBaseType_t count;
+} StaticQueue_t;
+
+typedef StaticQueue_t *QueueHandle_t;
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage,
+                                 StaticQueue_t *queue_buffer);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#endif // FREERTOS_QUEUE_H
@@ -0,0 +1,29 @@
+/*
+ * FreeRTOS Semaphore Host Shim
+ *
+ * Binary semaphores and mutexes as counting semaphores capped at one. The
+ * mutex has no priority inheritance, which only matters on target.
+ */
+
+#ifndef FREERTOS_SEMPHR_H
+#define FREERTOS_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t given;
+    uint32_t count;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+// Created empty, as on target
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *semaphore_buffer);
+// Created available
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *semaphore_buffer);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif // FREERTOS_SEMPHR_H
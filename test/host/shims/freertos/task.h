@@ -0,0 +1,51 @@
+/*
+ * FreeRTOS Task Host Shim
+ *
+ * Tasks run on detached threads. Each task has a 32-bit notification value
+ * with the FreeRTOS give/take and set-bits semantics.
+ */
+
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct host_task {
+    pthread_t thread;
+    const char *name;
+    TaskFunction_t function;
+    void *parameters;
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    uint32_t notify_value;
+    bool notify_pending;
+} StaticTask_t;
+
+typedef StaticTask_t *TaskHandle_t;
+
+typedef enum {
+    eNoAction,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+} eNotifyAction;
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                               void *parameters, UBaseType_t priority, StackType_t *stack,
+                               StaticTask_t *task_buffer);
+// NULL on threads not created through xTaskCreateStatic()
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+const char *pcTaskGetName(TaskHandle_t task);
+// Stacks are not tracked on the host; reports the whole stack as free
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value,
+                           TickType_t ticks_to_wait);
+#define xTaskNotifyGive(task) xTaskNotify((task), 0, eIncrement)
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+
+#endif // FREERTOS_TASK_H
@@ -0,0 +1,304 @@
+/*
+ * FreeRTOS Host Shim Implementation
+ *
+ * Timed waits convert ticks to an absolute CLOCK_MONOTONIC deadline, so a
+ * spurious wakeup never extends a timeout.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+static __thread TaskHandle_t current_task = NULL;
+
+static void host_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static struct timespec host_deadline(TickType_t ticks)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    uint64_t ns = (uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ) + (uint64_t)deadline.tv_nsec;
+    deadline.tv_sec += (time_t)(ns / 1000000000ULL);
+    deadline.tv_nsec = (long)(ns % 1000000000ULL);
+    return deadline;
+}
+
+// Wait on cond until woken or the deadline; false once the deadline has passed
+static bool host_wait(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks,
+                      const struct timespec *deadline)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+/*
+ * Tasks
+ */
+
+static void *host_task_entry(void *arg)
+{
+    TaskHandle_t task = arg;
+    current_task = task;
+    task->function(task->parameters);
+    return NULL;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                               void *parameters, UBaseType_t priority, StackType_t *stack,
+                               StaticTask_t *task_buffer)
+{
+    if (function == NULL || task_buffer == NULL) {
+        return NULL;
+    }
+
+    memset(task_buffer, 0, sizeof(*task_buffer));
+    task_buffer->name = name;
+    task_buffer->function = function;
+    task_buffer->parameters = parameters;
+    pthread_mutex_init(&task_buffer->lock, NULL);
+    host_cond_init(&task_buffer->notified);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&task_buffer->thread, &attr, host_task_entry, task_buffer);
+    pthread_attr_destroy(&attr);
+    return err == 0 ? task_buffer : NULL;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current_task;
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    task = task ? task : current_task;
+    return task ? task->name : "main";
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return 0;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    uint64_t ns = (uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ);
+    struct timespec delay = {
+        .tv_sec = (time_t)(ns / 1000000000ULL),
+        .tv_nsec = (long)(ns % 1000000000ULL),
+    };
+    while (nanosleep(&delay, &delay) != 0 && errno == EINTR) {
+        // Resume after signals
+    }
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    pthread_mutex_lock(&task->lock);
+    switch (action) {
+        case eNoAction:
+            break;
+        case eSetBits:
+            task->notify_value |= value;
+            break;
+        case eIncrement:
+            task->notify_value++;
+            break;
+        case eSetValueWithOverwrite:
+            task->notify_value = value;
+            break;
+    }
+    task->notify_pending = true;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value,
+                           TickType_t ticks_to_wait)
+{
+    TaskHandle_t task = current_task;
+    struct timespec deadline = host_deadline(ticks_to_wait);
+
+    pthread_mutex_lock(&task->lock);
+    if (!task->notify_pending) {
+        task->notify_value &= ~clear_on_entry;
+        while (!task->notify_pending && host_wait(&task->notified, &task->lock, ticks_to_wait, &deadline)) {
+            // Recheck after every wakeup
+        }
+    }
+    if (value) {
+        *value = task->notify_value;
+    }
+    BaseType_t received = task->notify_pending ? pdTRUE : pdFALSE;
+    if (received) {
+        task->notify_value &= ~clear_on_exit;
+        task->notify_pending = false;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return received;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    TaskHandle_t task = current_task;
+    struct timespec deadline = host_deadline(ticks_to_wait);
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_value == 0 && host_wait(&task->notified, &task->lock, ticks_to_wait, &deadline)) {
+        // Recheck after every wakeup
+    }
+    uint32_t count = task->notify_value;
+    if (count > 0) {
+        task->notify_value = clear_on_exit ? 0 : count - 1;
+    }
+    task->notify_pending = false;
+    pthread_mutex_unlock(&task->lock);
+    return count;
+}
+
+/*
+ * Queues
+ */
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage,
+                                 StaticQueue_t *queue_buffer)
+{
+    if (length == 0 || storage == NULL || queue_buffer == NULL) {
+        return NULL;
+    }
+
+    memset(queue_buffer, 0, sizeof(*queue_buffer));
+    pthread_mutex_init(&queue_buffer->lock, NULL);
+    host_cond_init(&queue_buffer->changed);
+    queue_buffer->storage = storage;
+    queue_buffer->item_size = item_size;
+    queue_buffer->length = length;
+    return queue_buffer;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = host_deadline(ticks_to_wait);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length && host_wait(&queue->changed, &queue->lock, ticks_to_wait, &deadline)) {
+        // Recheck after every wakeup
+    }
+    BaseType_t sent = pdFALSE;
+    if (queue->count < queue->length) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->changed);
+        sent = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return sent;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = host_deadline(ticks_to_wait);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && host_wait(&queue->changed, &queue->lock, ticks_to_wait, &deadline)) {
+        // Recheck after every wakeup
+    }
+    BaseType_t received = pdFALSE;
+    if (queue->count > 0) {
+        memcpy(item, queue->storage + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+        received = pdTRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return received;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+/*
+ * Semaphores
+ */
+
+static SemaphoreHandle_t host_semaphore_init(StaticSemaphore_t *semaphore_buffer, uint32_t count)
+{
+    if (semaphore_buffer == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&semaphore_buffer->lock, NULL);
+    host_cond_init(&semaphore_buffer->given);
+    semaphore_buffer->count = count;
+    return semaphore_buffer;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *semaphore_buffer)
+{
+    return host_semaphore_init(semaphore_buffer, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *semaphore_buffer)
+{
+    return host_semaphore_init(semaphore_buffer, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = host_deadline(ticks_to_wait);
+
+    pthread_mutex_lock(&semaphore->lock);
+    while (semaphore->count == 0 && host_wait(&semaphore->given, &semaphore->lock, ticks_to_wait, &deadline)) {
+        // Recheck after every wakeup
+    }
+    BaseType_t taken = pdFALSE;
+    if (semaphore->count > 0) {
+        semaphore->count--;
+        taken = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    pthread_mutex_lock(&semaphore->lock);
+    BaseType_t given = semaphore->count == 0 ? pdTRUE : pdFALSE;
+    semaphore->count = 1;
+    pthread_cond_signal(&semaphore->given);
+    pthread_mutex_unlock(&semaphore->lock);
+    return given;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    pthread_cond_destroy(&semaphore->given);
+    pthread_mutex_destroy(&semaphore->lock);
+}
@@ -0,0 +1,49 @@
+/*
+ * Timing Utility Host Backend on the System Clock
+ *
+ * Real-time counterpart of timing_host.c for benchmarks: the "cycle
+ * counter" counts nanoseconds of CLOCK_MONOTONIC and timing_monotonic_us()
+ * matches esp_timer_get_time() of the host shim.
+ */
+
+#include <time.h>
+#include "timing.h"
+
+static uint64_t clock_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+timing_cycles_t timing_cycles_now(void)
+{
+    return (timing_cycles_t)clock_now_ns();
+}
+
+void timing_init(void)
+{
+}
+
+uint32_t timing_cycles_per_us(void)
+{
+    return 1000;
+}
+
+uint32_t timing_read_overhead_cycles(void)
+{
+    return 0;
+}
+
+void timing_delay_us(uint32_t us)
+{
+    uint64_t end = clock_now_ns() + (uint64_t)us * 1000;
+    while (clock_now_ns() < end) {
+        // Busy wait
+    }
+}
+
+int64_t timing_monotonic_us(void)
+{
+    return (int64_t)(clock_now_ns() / 1000);
+}
@@ -0,0 +1,243 @@
+/*
+ * DHT22 Decoder Host Tests
+ *
+ * Runs the trace corpus through dht22_decode_edges(): clean and jittered
+ * frames, slow edges, negative temperatures, out-of-range values, and
+ * traces with dropped or extra edges and corrupted checksums.
+ */
+
+#include <string.h>
+#include "test_harness.h"
+#include "dht22_traces.h"
+
+static dht22_decode_status_t decode(const dht22_trace_t *trace, dht22_frame_t *frame)
+{
+    return dht22_decode_edges(trace->edges_us, trace->num_edges, trace->first_level, frame);
+}
+
+static dht22_decode_status_t decode_values(uint16_t humidity, int16_t temperature,
+                                           const dht22_trace_timing_t *timing, dht22_frame_t *frame)
+{
+    uint8_t data[DHT22_DATA_BYTES];
+    dht22_trace_t trace;
+    dht22_trace_bytes(humidity, temperature, data);
+    dht22_trace_build(data, timing, &trace);
+    return decode(&trace, frame);
+}
+
+static void test_nominal(void)
+{
+    dht22_frame_t frame;
+    CHECK_EQ(decode_values(652, 235, &dht22_timing_nominal, &frame), DHT22_DECODE_OK);
+    CHECK_EQ(frame.humidity_deci_pct, 652);
+    CHECK_EQ(frame.temperature_deci_c, 235);
+    CHECK_EQ(frame.response_low_us, 80);
+    CHECK_EQ(frame.response_high_us, 80);
+    CHECK_EQ(frame.error_bit, -1);
+    CHECK(frame.calibrated);
+    CHECK_EQ(frame.zero_high_us, 26);
+    CHECK_EQ(frame.one_high_us, 70);
+    CHECK_EQ(frame.bit_threshold_us, 48);
+    CHECK_EQ(frame.bit_margin_us, 22);
+}
+
+static void test_negative_temperature(void)
+{
+    static const int16_t temperatures[] = { -1, -101, -255, -400 };
+    for (size_t i = 0; i < sizeof(temperatures) / sizeof(temperatures[0]); i++) {
+        dht22_frame_t frame;
+        CHECK_EQ(decode_values(300, temperatures[i], &dht22_timing_nominal, &frame), DHT22_DECODE_OK);
+        CHECK_EQ(frame.temperature_deci_c, temperatures[i]);
+        CHECK(frame.data[2] & 0x80);
+    }
+}
+
+// One cluster only: every bit is 0, so the nominal threshold applies
+static void test_single_cluster(void)
+{
+    dht22_frame_t frame;
+    CHECK_EQ(decode_values(0, 0, &dht22_timing_nominal, &frame), DHT22_DECODE_OK);
+    CHECK(!frame.calibrated);
+    CHECK_EQ(frame.one_high_us, 0);
+    CHECK_EQ(frame.bit_threshold_us, 48);
+}
+
+static void test_jitter(void)
+{
+    // Sweep seeds and values; +-10 us on every pulse stays well inside the bit margin
+    dht22_trace_timing_t timing = dht22_timing_nominal;
+    timing.jitter_us = 10;
+    int failures = 0;
+    for (uint32_t seed = 1; seed <= 500; seed++) {
+        timing.seed = seed;
+        uint16_t humidity = (uint16_t)(seed * 7 % 1001);
+        int16_t temperature = (int16_t)((int32_t)(seed * 13 % 1201) - 400);
+        dht22_frame_t frame;
+        if (decode_values(humidity, temperature, &timing, &frame) != DHT22_DECODE_OK ||
+            frame.humidity_deci_pct != humidity || frame.temperature_deci_c != temperature) {
+            failures++;
+        }
+    }
+    CHECK_EQ(failures, 0);
+}
+
+static void test_slow_edges(void)
+{
+    // Zero bits at 48 us sit on the nominal threshold; only the per-frame
+    // classifier decodes this reliably
+    dht22_frame_t frame;
+    CHECK_EQ(decode_values(873, -57, &dht22_timing_slow_edges, &frame), DHT22_DECODE_OK);
+    CHECK_EQ(frame.humidity_deci_pct, 873);
+    CHECK_EQ(frame.temperature_deci_c, -57);
+    CHECK(frame.calibrated);
+    CHECK(frame.bit_threshold_us > 60 && frame.bit_threshold_us < 80);
+}
+
+static void test_bad_checksum(void)
+{
+    uint8_t data[DHT22_DATA_BYTES];
+    dht22_trace_t trace;
+    dht22_frame_t frame;
+    dht22_trace_bytes(500, 200, data);
+    data[4] ^= 0x01;
+    dht22_trace_build(data, &dht22_timing_nominal, &trace);
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_CHECKSUM);
+    CHECK_EQ(frame.data[4], data[4]);
+    CHECK_EQ(frame.humidity_deci_pct, 0);
+
+    // A flipped data bit is caught the same way
+    dht22_trace_bytes(500, 200, data);
+    data[1] ^= 0x10;
+    dht22_trace_build(data, &dht22_timing_nominal, &trace);
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_CHECKSUM);
+}
+
+// Checksum-valid frames outside -40..80 °C or above 100 %RH are rejected
+static void test_out_of_range_values(void)
+{
+    static const struct {
+        uint16_t humidity;
+        int16_t temperature;
+        dht22_decode_status_t status;
+    } cases[] = {
+        { 1000, 800, DHT22_DECODE_OK },
+        { 0, -400, DHT22_DECODE_OK },
+        { 1001, 200, DHT22_DECODE_ERR_RANGE },
+        { 0xFFFF, 200, DHT22_DECODE_ERR_RANGE },
+        { 500, 801, DHT22_DECODE_ERR_RANGE },
+        { 500, -401, DHT22_DECODE_ERR_RANGE },
+        { 500, 0x7FFF, DHT22_DECODE_ERR_RANGE },
+        { 500, -0x7FFF, DHT22_DECODE_ERR_RANGE },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        dht22_frame_t frame;
+        CHECK_EQ(decode_values(cases[i].humidity, cases[i].temperature, &dht22_timing_nominal, &frame),
+                 cases[i].status);
+        // The values are still reported for diagnostics
+        CHECK_EQ(frame.humidity_deci_pct, cases[i].humidity);
+        CHECK_EQ(frame.temperature_deci_c, cases[i].temperature);
+    }
+}
+
+static void test_dropped_edges(void)
+{
+    uint8_t data[DHT22_DATA_BYTES];
+    dht22_trace_t clean;
+    dht22_trace_t trace;
+    dht22_frame_t frame;
+    dht22_trace_bytes(652, 235, data);
+    dht22_trace_build(data, &dht22_timing_nominal, &clean);
+
+    // Losing the host start signal does not matter; the frame is found from the end
+    trace = clean;
+    dht22_trace_drop_edges(&trace, 0, 2);
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_OK);
+
+    // A single missed edge leaves the trace ending on the wrong level
+    trace = clean;
+    dht22_trace_drop_edges(&trace, dht22_trace_bit_edge(17) + 1, 1);
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_INCOMPLETE);
+
+    // A missed pulse merges three phases; the frame shifts onto the start signal
+    trace = clean;
+    dht22_trace_drop_edges(&trace, dht22_trace_bit_edge(17) + 1, 2);
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_RESPONSE_LOW);
+    CHECK_EQ(frame.error_pulse_us, 1100);
+
+    // Truncated capture
+    trace = clean;
+    trace.num_edges -= 10;
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_INCOMPLETE);
+
+    CHECK_EQ(dht22_decode_edges(clean.edges_us, 0, 0, &frame), DHT22_DECODE_ERR_ARG);
+    CHECK_EQ(dht22_decode_edges(NULL, clean.num_edges, 0, &frame), DHT22_DECODE_ERR_ARG);
+}
+
+static void test_glitch(void)
+{
+    uint8_t data[DHT22_DATA_BYTES];
+    dht22_trace_t trace;
+    dht22_frame_t frame;
+    dht22_trace_bytes(652, 235, data);
+    dht22_trace_build(data, &dht22_timing_nominal, &trace);
+
+    // A 2 us dip inside bit 20's high phase shows up as a short low phase
+    dht22_trace_insert_glitch(&trace, dht22_trace_bit_edge(20) + 1, 10, 2);
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_BIT_LOW);
+    CHECK_EQ(frame.error_bit, 20);
+    CHECK_EQ(frame.error_pulse_us, 2);
+}
+
+static void test_out_of_range_pulses(void)
+{
+    uint8_t data[DHT22_DATA_BYTES];
+    dht22_trace_t trace;
+    dht22_frame_t frame;
+    dht22_trace_bytes(652, 235, data);
+
+    dht22_trace_timing_t timing = dht22_timing_nominal;
+    timing.response_high_us = 200;
+    dht22_trace_build(data, &timing, &trace);
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_RESPONSE_HIGH);
+    CHECK_EQ(frame.error_pulse_us, 200);
+
+    // Stretch the high phase of bit 33
+    dht22_trace_build(data, &dht22_timing_nominal, &trace);
+    size_t edge = dht22_trace_bit_edge(33) + 2;
+    for (size_t i = edge; i < trace.num_edges; i++) {
+        trace.edges_us[i] += 100;
+    }
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_ERR_BIT_HIGH);
+    CHECK_EQ(frame.error_bit, 33);
+}
+
+// Timestamps come from a free-running counter and may wrap mid-frame
+static void test_timestamp_wrap(void)
+{
+    uint8_t data[DHT22_DATA_BYTES];
+    dht22_trace_t trace;
+    dht22_frame_t frame;
+    dht22_trace_bytes(412, -33, data);
+    dht22_trace_build(data, &dht22_timing_nominal, &trace);
+    for (size_t i = 0; i < trace.num_edges; i++) {
+        trace.edges_us[i] += UINT32_MAX - 2000;
+    }
+    CHECK_EQ(decode(&trace, &frame), DHT22_DECODE_OK);
+    CHECK_EQ(frame.temperature_deci_c, -33);
+}
+
+int main(void)
+{
+    RUN_TEST(test_nominal);
+    RUN_TEST(test_negative_temperature);
+    RUN_TEST(test_single_cluster);
+    RUN_TEST(test_jitter);
+    RUN_TEST(test_slow_edges);
+    RUN_TEST(test_bad_checksum);
+    RUN_TEST(test_out_of_range_values);
+    RUN_TEST(test_dropped_edges);
+    RUN_TEST(test_glitch);
+    RUN_TEST(test_out_of_range_pulses);
+    RUN_TEST(test_timestamp_wrap);
+    return TEST_EXIT();
+}
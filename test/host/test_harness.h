@@ -0,0 +1,54 @@
+/*
+ * Host Test Harness
+ *
+ * Minimal assertion macros for the host tests. A failed check reports its
+ * location and the test keeps running; the process exits non-zero if any
+ * check failed.
+ */
+
+#ifndef TEST_HARNESS_H
+#define TEST_HARNESS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static int test_failures __attribute__((unused));
+
+#define CHECK(cond)                                                                      \
+    do {                                                                                 \
+        if (!(cond)) {                                                                   \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);              \
+            test_failures++;                                                             \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                       \
+    do {                                                                                 \
+        long long actual_ = (long long)(actual);                                         \
+        long long expected_ = (long long)(expected);                                     \
+        if (actual_ != expected_) {                                                      \
+            printf("%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual,    \
+                   actual_, expected_);                                                  \
+            test_failures++;                                                             \
+        }                                                                                \
+    } while (0)
+
+#define RUN_TEST(fn)                                                                     \
+    do {                                                                                 \
+        int before_ = test_failures;                                                     \
+        fn();                                                                            \
+        printf("%-40s %s\n", #fn, test_failures == before_ ? "ok" : "FAILED");           \
+    } while (0)
+
+#define TEST_EXIT() (test_failures ? 1 : 0)
+
+// Wall-clock nanoseconds for the benchmarks
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#endif // TEST_HARNESS_H
@@ -0,0 +1,101 @@
+/*
+ * HC-SR04 Echo Arithmetic Host Tests
+ *
+ * Speed of sound over the whole temperature range, the echo window, the
+ * median of odd and even ping counts and the echo to distance conversion,
+ * including saturation and a round trip through the echo window.
+ */
+
+#include "test_harness.h"
+#include "hcsr04_echo.h"
+
+static void test_speed_of_sound(void)
+{
+    CHECK_EQ(hcsr04_speed_of_sound_mm_s(0), 331300);
+    CHECK_EQ(hcsr04_speed_of_sound_mm_s(2000), 343420);
+    CHECK_EQ(hcsr04_speed_of_sound_mm_s(-4000), 307060);
+    CHECK_EQ(hcsr04_speed_of_sound_mm_s(10000), 391900);
+    // Fractions of a mm/s truncate toward zero on both sides of 0 °C
+    CHECK_EQ(hcsr04_speed_of_sound_mm_s(1), 331306);
+    CHECK_EQ(hcsr04_speed_of_sound_mm_s(-1), 331294);
+
+    // Monotonic and positive over the whole int16_t range, without overflow
+    uint32_t previous = hcsr04_speed_of_sound_mm_s(INT16_MIN);
+    CHECK(previous > 0);
+    for (int32_t t = INT16_MIN + 1; t <= INT16_MAX; t++) {
+        uint32_t speed = hcsr04_speed_of_sound_mm_s((int16_t)t);
+        CHECK(speed >= previous);
+        previous = speed;
+    }
+}
+
+static void test_max_echo(void)
+{
+    CHECK_EQ(hcsr04_max_echo_us(4000, 343420), 23295);
+    CHECK_EQ(hcsr04_max_echo_us(0, 343420), 0);
+    CHECK_EQ(hcsr04_max_echo_us(UINT16_MAX, 307060), 426854);
+}
+
+static void test_median_odd(void)
+{
+    uint16_t echoes[] = { 300, 100, 200 };
+    CHECK_EQ(hcsr04_echo_median(echoes, 3), 200);
+    CHECK_EQ(echoes[0], 100);
+    CHECK_EQ(echoes[1], 200);
+    CHECK_EQ(echoes[2], 300);
+
+    uint16_t reversed[] = { 7000, 6000, 5000, 4000, 3000, 2000, 1000 };
+    CHECK_EQ(hcsr04_echo_median(reversed, 7), 4000);
+    for (int i = 1; i < 7; i++) {
+        CHECK(reversed[i - 1] <= reversed[i]);
+    }
+
+    // One outlier among equal echoes does not move the median
+    uint16_t spike[] = { 5831, 5831, 900, 5831, 5831 };
+    CHECK_EQ(hcsr04_echo_median(spike, 5), 5831);
+}
+
+static void test_median_even_and_single(void)
+{
+    uint16_t echoes[] = { 400, 100, 300, 200 };
+    CHECK_EQ(hcsr04_echo_median(echoes, 4), 300);
+
+    uint16_t pair[] = { 2000, 1000 };
+    CHECK_EQ(hcsr04_echo_median(pair, 2), 2000);
+
+    uint16_t single[] = { 1234 };
+    CHECK_EQ(hcsr04_echo_median(single, 1), 1234);
+
+    // Only the first count entries are considered
+    uint16_t partial[] = { 500, 100, 9 };
+    CHECK_EQ(hcsr04_echo_median(partial, 2), 500);
+    CHECK_EQ(partial[2], 9);
+
+    CHECK_EQ(hcsr04_echo_median(NULL, 0), 0);
+}
+
+static void test_distance(void)
+{
+    CHECK_EQ(hcsr04_echo_distance_mm(0, 343420), 0);
+    CHECK_EQ(hcsr04_echo_distance_mm(5831, 343420), 1001);
+    CHECK_EQ(hcsr04_echo_distance_mm(23295, 343420), 3999);
+    CHECK_EQ(hcsr04_echo_distance_mm(UINT32_MAX, 391900), UINT16_MAX);
+
+    // An echo of the full window maps back to the range it was computed for
+    uint32_t sound = hcsr04_speed_of_sound_mm_s(2000);
+    for (uint32_t mm = 20; mm <= 4000; mm += 20) {
+        uint16_t distance = hcsr04_echo_distance_mm(hcsr04_max_echo_us((uint16_t)mm, sound), sound);
+        CHECK(distance <= mm);
+        CHECK((uint32_t)distance + 1 >= mm);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(test_speed_of_sound);
+    RUN_TEST(test_max_echo);
+    RUN_TEST(test_median_odd);
+    RUN_TEST(test_median_even_and_single);
+    RUN_TEST(test_distance);
+    return TEST_EXIT();
+}
@@ -0,0 +1,242 @@
+/*
+ * Sensor Filter Host Tests
+ *
+ * Each stage on its own (calibration, median, EMA, rate limit), including
+ * the first samples before a median window has filled, then a full chain.
+ */
+
+#include <string.h>
+#include "test_harness.h"
+#include "sensor_filter.h"
+
+static sensor_filter_t filter;
+
+static void init_single(const sensor_filter_stage_t *stage)
+{
+    sensor_filter_config_t config = { .num_stages = 1 };
+    config.stages[0] = *stage;
+    CHECK(sensor_filter_init(&filter, &config));
+}
+
+static int32_t apply(int64_t now_us, int32_t value)
+{
+    CHECK(sensor_filter_apply(&filter, now_us, &value));
+    return value;
+}
+
+static void test_config_validation(void)
+{
+    sensor_filter_config_t config = { .num_stages = 1 };
+
+    config.stages[0] = (sensor_filter_stage_t) { .type = SENSOR_FILTER_MEDIAN, .median.window = 0 };
+    CHECK(!sensor_filter_init(&filter, &config));
+    config.stages[0].median.window = SENSOR_FILTER_MEDIAN_MAX + 1;
+    CHECK(!sensor_filter_init(&filter, &config));
+    config.stages[0].median.window = SENSOR_FILTER_MEDIAN_MAX;
+    CHECK(sensor_filter_init(&filter, &config));
+
+    config.stages[0] = (sensor_filter_stage_t) { .type = SENSOR_FILTER_EMA, .ema.shift = 17 };
+    CHECK(!sensor_filter_init(&filter, &config));
+    config.stages[0] = (sensor_filter_stage_t) { .type = SENSOR_FILTER_RATE_LIMIT, .rate.max_per_s = 0 };
+    CHECK(!sensor_filter_init(&filter, &config));
+    config.stages[0] = (sensor_filter_stage_t) { .type = (sensor_filter_type_t)42 };
+    CHECK(!sensor_filter_init(&filter, &config));
+
+    config.num_stages = SENSOR_FILTER_MAX_STAGES + 1;
+    CHECK(!sensor_filter_init(&filter, &config));
+
+    // An empty chain passes samples through
+    config.num_stages = 0;
+    CHECK(sensor_filter_init(&filter, &config));
+    CHECK_EQ(apply(0, -1234), -1234);
+}
+
+static void test_calibrate(void)
+{
+    init_single(&(sensor_filter_stage_t) {
+        .type = SENSOR_FILTER_CALIBRATE,
+        .calibrate = { .offset = -50, .scale_q16 = SENSOR_FILTER_SCALE_ONE * 3 / 2 },
+    });
+    CHECK_EQ(apply(0, 1000), 1450);
+    CHECK_EQ(apply(0, 0), -50);
+    CHECK_EQ(apply(0, -1000), -1550);
+    // Division truncates toward zero for negative products
+    CHECK_EQ(apply(0, 1), -49);
+    CHECK_EQ(apply(0, -1), -51);
+
+    // Results saturate instead of wrapping
+    init_single(&(sensor_filter_stage_t) {
+        .type = SENSOR_FILTER_CALIBRATE,
+        .calibrate = { .offset = 0, .scale_q16 = 4 * SENSOR_FILTER_SCALE_ONE },
+    });
+    CHECK_EQ(apply(0, INT32_MAX / 2), INT32_MAX);
+    CHECK_EQ(apply(0, INT32_MIN / 2), INT32_MIN);
+}
+
+static void test_median_filling(void)
+{
+    init_single(&(sensor_filter_stage_t) { .type = SENSOR_FILTER_MEDIAN, .median.window = 5 });
+
+    // Until the window is full the median is over the samples seen so far;
+    // with an even count the upper of the middle two is used
+    CHECK_EQ(apply(0, 10), 10);
+    CHECK_EQ(apply(0, 30), 30);
+    CHECK_EQ(apply(0, 20), 20);
+    CHECK_EQ(apply(0, 1000), 30);
+    CHECK_EQ(apply(0, 15), 20);
+}
+
+static void test_median_spikes(void)
+{
+    init_single(&(sensor_filter_stage_t) { .type = SENSOR_FILTER_MEDIAN, .median.window = 3 });
+    CHECK_EQ(apply(0, 100), 100);
+    CHECK_EQ(apply(0, 101), 101);
+    CHECK_EQ(apply(0, 9999), 101);      // Single spike rejected
+    CHECK_EQ(apply(0, 102), 102);
+    CHECK_EQ(apply(0, -9999), 102);
+    CHECK_EQ(apply(0, 103), 102);
+
+    // The window slides: once the spike has left, a new level passes
+    CHECK_EQ(apply(0, 500), 103);
+    CHECK_EQ(apply(0, 500), 500);
+
+    // Window of one is a pass-through
+    init_single(&(sensor_filter_stage_t) { .type = SENSOR_FILTER_MEDIAN, .median.window = 1 });
+    CHECK_EQ(apply(0, 7), 7);
+    CHECK_EQ(apply(0, -7), -7);
+}
+
+static void test_ema(void)
+{
+    // The first sample primes the average
+    init_single(&(sensor_filter_stage_t) { .type = SENSOR_FILTER_EMA, .ema.shift = 2 });
+    CHECK_EQ(apply(0, 2000), 2000);
+    CHECK_EQ(apply(0, 2400), 2100);
+    CHECK_EQ(apply(0, 2400), 2175);
+    CHECK_EQ(apply(0, 2400), 2231);
+
+    // Shift 0 passes samples through
+    init_single(&(sensor_filter_stage_t) { .type = SENSOR_FILTER_EMA, .ema.shift = 0 });
+    CHECK_EQ(apply(0, 5), 5);
+    CHECK_EQ(apply(0, -500), -500);
+
+    // Negative values average symmetrically
+    init_single(&(sensor_filter_stage_t) { .type = SENSOR_FILTER_EMA, .ema.shift = 1 });
+    CHECK_EQ(apply(0, -1000), -1000);
+    CHECK_EQ(apply(0, -2000), -1500);
+}
+
+// A step input must settle on the new level for every shift, including
+// shifts wider than the accumulator's fraction
+static void test_ema_converges(void)
+{
+    static const int32_t steps[] = { 1, 7, 100, -100, 25000, -25000 };
+    for (uint8_t shift = 1; shift <= 16; shift++) {
+        for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+            init_single(&(sensor_filter_stage_t) { .type = SENSOR_FILTER_EMA, .ema.shift = shift });
+            apply(0, 0);
+            int32_t out = 0;
+            // 24 time constants
+            for (int n = 0; n < (24 << shift); n++) {
+                out = apply(0, steps[s]);
+            }
+            if (out != steps[s]) {
+                printf("  shift %u, step %d: settled at %d\n", shift, steps[s], out);
+                test_failures++;
+            }
+        }
+    }
+}
+
+static void test_rate_limit(void)
+{
+    init_single(&(sensor_filter_stage_t) {
+        .type = SENSOR_FILTER_RATE_LIMIT,
+        .rate = { .max_per_s = 100, .max_rejects = 2 },
+    });
+    int32_t value = 1000;
+    CHECK(sensor_filter_apply(&filter, 0, &value));
+
+    // 100 per second: +100 after 1 s is allowed, +101 is not
+    value = 1100;
+    CHECK(sensor_filter_apply(&filter, 1000000, &value));
+    value = 1301;
+    CHECK(!sensor_filter_apply(&filter, 3000000, &value));
+    CHECK_EQ(value, 1301);
+    value = 900;
+    CHECK(sensor_filter_apply(&filter, 3000000, &value));
+
+    // After max_rejects consecutive rejects the new level is accepted
+    value = 5000;
+    CHECK(!sensor_filter_apply(&filter, 3100000, &value));
+    value = 5000;
+    CHECK(!sensor_filter_apply(&filter, 3200000, &value));
+    value = 5000;
+    CHECK(sensor_filter_apply(&filter, 3300000, &value));
+    CHECK_EQ(value, 5000);
+
+    // An accepted sample resets the reject count
+    value = 9000;
+    CHECK(!sensor_filter_apply(&filter, 3400000, &value));
+    value = 5001;
+    CHECK(sensor_filter_apply(&filter, 3500000, &value));
+    value = 9000;
+    CHECK(!sensor_filter_apply(&filter, 3600000, &value));
+    value = 9000;
+    CHECK(!sensor_filter_apply(&filter, 3700000, &value));
+
+    // Extreme values do not overflow the change
+    init_single(&(sensor_filter_stage_t) {
+        .type = SENSOR_FILTER_RATE_LIMIT,
+        .rate = { .max_per_s = INT32_MAX, .max_rejects = 1 },
+    });
+    value = INT32_MIN;
+    CHECK(sensor_filter_apply(&filter, 0, &value));
+    value = INT32_MAX;
+    CHECK(!sensor_filter_apply(&filter, 1000, &value));
+    value = INT32_MAX;
+    CHECK(sensor_filter_apply(&filter, 2000000, &value));
+}
+
+static void test_chain(void)
+{
+    // Calibrate, reject spikes, limit the rate, then smooth
+    sensor_filter_config_t config = {
+        .num_stages = 4,
+        .stages = {
+            { .type = SENSOR_FILTER_CALIBRATE, .calibrate = { .offset = -100, .scale_q16 = SENSOR_FILTER_SCALE_ONE } },
+            { .type = SENSOR_FILTER_MEDIAN, .median.window = 3 },
+            { .type = SENSOR_FILTER_RATE_LIMIT, .rate = { .max_per_s = 50, .max_rejects = 3 } },
+            { .type = SENSOR_FILTER_EMA, .ema.shift = 1 },
+        },
+    };
+    CHECK(sensor_filter_init(&filter, &config));
+
+    CHECK_EQ(apply(0, 2100), 2000);
+    CHECK_EQ(apply(1000000, 2140), 2020);
+    CHECK_EQ(apply(2000000, 9000), 2030);      // Spike removed by the median
+    CHECK_EQ(apply(3000000, 2140), 2035);
+
+    // A step the median passes but the rate limit rejects leaves the output
+    // alone until max_rejects is exhausted, then the smoothing takes over
+    for (int64_t t = 3100000; t <= 3300000; t += 100000) {
+        int32_t value = 3000;
+        CHECK(!sensor_filter_apply(&filter, t, &value));
+        CHECK_EQ(value, 3000);
+    }
+    CHECK_EQ(apply(3400000, 3000), 2468);
+    CHECK_EQ(apply(3500000, 3000), 2684);
+}
+
+int main(void)
+{
+    RUN_TEST(test_config_validation);
+    RUN_TEST(test_calibrate);
+    RUN_TEST(test_median_filling);
+    RUN_TEST(test_median_spikes);
+    RUN_TEST(test_ema);
+    RUN_TEST(test_ema_converges);
+    RUN_TEST(test_rate_limit);
+    RUN_TEST(test_chain);
+    return TEST_EXIT();
+}
@@ -0,0 +1,214 @@
+/*
+ * Sensor Manager Host Tests
+ *
+ * The update task, on-demand reads and scheduling, run on the FreeRTOS
+ * host shim with mock drivers whose reads complete from their own threads.
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include "test_harness.h"
+#include "sensor_manager.h"
+#include "sensor_dht22.h"
+#include "sensor_hcsr04.h"
+#include "timing.h"
+
+#define MOCK_SENSORS 3
+
+typedef struct {
+    bool fail_start;             // read_async refuses to start
+    uint32_t read_ms;
+    sensor_driver_done_t done;
+    void *done_ctx;
+    uint32_t reads_done;
+    int64_t done_at_us;
+} mock_sensor_t;
+
+static mock_sensor_t mocks[MOCK_SENSORS];
+static int mock_registered;
+
+static void sleep_ms(uint32_t ms)
+{
+    struct timespec delay = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long)(ms % 1000) * 1000000L,
+    };
+    nanosleep(&delay, NULL);
+}
+
+static bool mock_read(void *ctx, sensor_reading_t *reading)
+{
+    reading->data.env.temperature_centi_c = 2000;
+    reading->data.env.humidity_centi_pct = 5000;
+    reading->valid = true;
+    return true;
+}
+
+static void *mock_complete(void *arg)
+{
+    mock_sensor_t *mock = arg;
+    sleep_ms(mock->read_ms);
+
+    sensor_reading_t reading = { .valid = false };
+    mock_read(mock, &reading);
+    mock->done(mock->done_ctx, &reading);
+    __atomic_store_n(&mock->done_at_us, timing_monotonic_us(), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&mock->reads_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static bool mock_read_async(void *ctx, sensor_driver_done_t done, void *done_ctx)
+{
+    mock_sensor_t *mock = ctx;
+    if (mock->fail_start) {
+        return false;
+    }
+
+    mock->done = done;
+    mock->done_ctx = done_ctx;
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&thread, &attr, mock_complete, mock);
+    pthread_attr_destroy(&attr);
+    return err == 0;
+}
+
+static const sensor_driver_t mock_driver = {
+    .name = "mock",
+    .type = SENSOR_TYPE_ENVIRONMENTAL,
+    .read = mock_read,
+    .read_async = mock_read_async,
+};
+
+static bool mock_register(sensor_id_t *ret_id)
+{
+    if (mock_registered >= MOCK_SENSORS || !sensor_register(&mock_driver, &mocks[mock_registered], ret_id)) {
+        return false;
+    }
+    mock_registered++;
+    return true;
+}
+
+// Board sensors of sensor_init(), replaced by mocks
+bool sensor_dht22_register(int gpio_pin, sensor_id_t *ret_id)
+{
+    return mock_register(ret_id);
+}
+
+bool sensor_hcsr04_register(int trigger_pin, int echo_pin, sensor_id_t *ret_id)
+{
+    return mock_register(ret_id);
+}
+
+static void test_request_fails_when_read_cannot_start(void)
+{
+    mocks[0].fail_start = true;
+
+    sensor_reading_t reading;
+    int64_t start = timing_monotonic_us();
+    CHECK(!sensor_manager_request_read(0, 0, 2000, &reading));
+    // Failed by the update task, not by the requester's timeout
+    CHECK(timing_monotonic_us() - start < 500000);
+    CHECK(!reading.valid);
+    CHECK_EQ(reading.id, 0);
+
+    mocks[0].fail_start = false;
+    CHECK(sensor_manager_request_read(0, 0, 2000, &reading));
+    CHECK(reading.valid);
+}
+
+static void test_request_joins_scheduled_read(void)
+{
+    mocks[1].read_ms = 200;
+    CHECK(sensor_manager_schedule(1, 60 * 1000, 0));
+    sleep_ms(50);
+
+    sensor_manager_status_t before;
+    CHECK(sensor_manager_get_status(&before));
+    CHECK_EQ(before.reads_in_flight, 1);
+
+    sensor_reading_t reading;
+    CHECK(sensor_manager_request_read(1, 0, 2000, &reading));
+    CHECK(reading.valid);
+
+    // One read served both, and joining it is not a skipped deadline
+    sensor_manager_status_t after;
+    CHECK(sensor_manager_get_status(&after));
+    CHECK_EQ(after.reads_started, before.reads_started);
+    CHECK_EQ(after.deadlines_skipped, before.deadlines_skipped);
+
+    CHECK(sensor_manager_unschedule(1));
+    mocks[1].read_ms = 5;
+}
+
+// Waits for the next completion of a mock; false after timeout_ms
+static bool wait_read_done(mock_sensor_t *mock, uint32_t timeout_ms)
+{
+    uint32_t reads = __atomic_load_n(&mock->reads_done, __ATOMIC_ACQUIRE);
+    for (uint32_t waited = 0; waited < timeout_ms; waited++) {
+        if (__atomic_load_n(&mock->reads_done, __ATOMIC_ACQUIRE) != reads) {
+            return true;
+        }
+        sleep_ms(1);
+    }
+    return false;
+}
+
+static void test_adaptive_off_restores_deadline(void)
+{
+    sensor_adaptive_config_t adaptive = {
+        .min_period_ms = 50,
+        .max_period_ms = 10 * 1000,
+        .activity_threshold = { [SENSOR_CHANNEL_TEMPERATURE] = 100 },
+    };
+    CHECK(sensor_manager_schedule(2, 50, 0));
+    CHECK(sensor_manager_set_adaptive(2, &adaptive));
+
+    // Constant readings stretch the period by a quarter per sample
+    uint32_t period = 0;
+    while (period < 400) {
+        if (!wait_read_done(&mocks[2], 2000)) {
+            CHECK(false);
+            break;
+        }
+        CHECK(sensor_manager_get_sample_period(2, &period));
+    }
+    // Right after a read, the next one is a stretched period away
+    CHECK(wait_read_done(&mocks[2], 2000));
+    sleep_ms(10);
+
+    CHECK(sensor_manager_set_adaptive(2, NULL));
+    CHECK(sensor_manager_get_sample_period(2, &period));
+    CHECK_EQ(period, 50);
+    int64_t start = timing_monotonic_us();
+    CHECK(wait_read_done(&mocks[2], 2000));
+    CHECK(timing_monotonic_us() - start < 250000);
+
+    CHECK(sensor_manager_unschedule(2));
+}
+
+int main(void)
+{
+    for (int i = 0; i < MOCK_SENSORS; i++) {
+        mocks[i].read_ms = 5;
+    }
+
+    CHECK(sensor_manager_init());
+    sensor_id_t id;
+    while (mock_registered < MOCK_SENSORS && mock_register(&id)) {
+    }
+    CHECK_EQ(sensor_count(), MOCK_SENSORS);
+
+    // Start without schedules; each test schedules what it needs
+    CHECK(sensor_manager_start_updates(60 * 1000));
+    for (sensor_id_t i = 0; i < MOCK_SENSORS; i++) {
+        sensor_manager_unschedule(i);
+    }
+
+    RUN_TEST(test_request_fails_when_read_cannot_start);
+    RUN_TEST(test_request_joins_scheduled_read);
+    RUN_TEST(test_adaptive_off_restores_deadline);
+    return TEST_EXIT();
+}
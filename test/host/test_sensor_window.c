@@ -0,0 +1,200 @@
+/*
+ * Sensor Window Host Tests
+ *
+ * Checks sensor_window against a brute-force model that keeps every
+ * sample and rescans them on each query, over random sample streams with
+ * gaps, bursts, late samples and jumps past the window.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test_harness.h"
+#include "sensor_window.h"
+
+#define NAIVE_MAX_SAMPLES 20000
+
+// Every sample with the bucket the window files it under
+typedef struct {
+    uint32_t bucket_s;
+    uint32_t newest;             // Newest bucket seen by add or get
+    bool started;
+    uint32_t count;
+    uint32_t buckets[NAIVE_MAX_SAMPLES];
+    int32_t values[NAIVE_MAX_SAMPLES];
+} naive_window_t;
+
+static void naive_init(naive_window_t *naive, uint32_t window_s)
+{
+    naive->bucket_s = window_s / SENSOR_WINDOW_BUCKETS ? window_s / SENSOR_WINDOW_BUCKETS : 1;
+    naive->started = false;
+    naive->newest = 0;
+    naive->count = 0;
+}
+
+static void naive_advance(naive_window_t *naive, uint32_t now_s)
+{
+    uint32_t bucket = now_s / naive->bucket_s;
+    if (!naive->started || bucket > naive->newest) {
+        naive->newest = bucket;
+        naive->started = true;
+    }
+}
+
+static void naive_add(naive_window_t *naive, uint32_t now_s, int32_t value)
+{
+    naive_advance(naive, now_s);
+    naive->buckets[naive->count] = naive->newest;
+    naive->values[naive->count] = value;
+    naive->count++;
+}
+
+static bool naive_get(naive_window_t *naive, uint32_t now_s, sensor_window_stats_t *stats)
+{
+    if (!naive->started) {
+        return false;
+    }
+    naive_advance(naive, now_s);
+
+    // The open bucket plus SENSOR_WINDOW_BUCKETS - 1 closed ones
+    uint32_t count = 0;
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < naive->count; i++) {
+        if (naive->buckets[i] + SENSOR_WINDOW_BUCKETS <= naive->newest) {
+            continue;
+        }
+        int32_t value = naive->values[i];
+        if (count == 0 || value < stats->min) {
+            stats->min = value;
+        }
+        if (count == 0 || value > stats->max) {
+            stats->max = value;
+        }
+        sum += value;
+        count++;
+    }
+    if (count == 0) {
+        return false;
+    }
+    stats->mean = (int32_t)(sum / (int64_t)count);
+    stats->count = count;
+    return true;
+}
+
+static int compare(sensor_window_t *window, naive_window_t *naive, uint32_t now_s)
+{
+    sensor_window_stats_t got = { 0 }, expected = { 0 };
+    bool got_ok = sensor_window_get(window, now_s, &got);
+    bool expected_ok = naive_get(naive, now_s, &expected);
+    if (got_ok != expected_ok) {
+        printf("  t=%u: window %s, model %s\n", now_s, got_ok ? "has samples" : "empty",
+               expected_ok ? "has samples" : "empty");
+        return 1;
+    }
+    if (got_ok && (got.min != expected.min || got.max != expected.max || got.mean != expected.mean ||
+                   got.count != expected.count)) {
+        printf("  t=%u: window min %d max %d mean %d count %u, model min %d max %d mean %d count %u\n",
+               now_s, got.min, got.max, got.mean, got.count, expected.min, expected.max, expected.mean,
+               expected.count);
+        return 1;
+    }
+    return 0;
+}
+
+// The late sample from the review: a query at t=20160 opens bucket 14 of a
+// 24 h window, then a sample taken at t=20159 (bucket 13) arrives
+static void test_late_sample_keeps_window(void)
+{
+    sensor_window_t window;
+    sensor_window_stats_t stats;
+    sensor_window_init(&window, 24 * 3600);
+
+    uint32_t t = 0;
+    for (int i = 0; i < 334; i++) {
+        t = (uint32_t)i * 60;
+        sensor_window_add(&window, t, 2000 + i % 10);
+    }
+    CHECK(sensor_window_get(&window, 20160, &stats));
+    CHECK_EQ(stats.count, 334);
+    sensor_window_add(&window, 20159, 5000);
+    CHECK(sensor_window_get(&window, 20160, &stats));
+    CHECK_EQ(stats.count, 335);
+    CHECK_EQ(stats.max, 5000);
+    CHECK_EQ(stats.min, 2000);
+}
+
+static void test_jump_past_window(void)
+{
+    sensor_window_t window;
+    sensor_window_stats_t stats;
+    sensor_window_init(&window, 60);
+
+    sensor_window_add(&window, 10, 7);
+    CHECK(sensor_window_get(&window, 69, &stats));
+    CHECK_EQ(stats.count, 1);
+    CHECK(!sensor_window_get(&window, 70, &stats));
+    sensor_window_add(&window, 1000000, -3);
+    CHECK(sensor_window_get(&window, 1000000, &stats));
+    CHECK_EQ(stats.count, 1);
+    CHECK_EQ(stats.mean, -3);
+}
+
+static uint32_t random_step(uint32_t bucket_s)
+{
+    switch (rand() % 20) {
+        case 0:
+            return (uint32_t)(rand() % (int)(SENSOR_WINDOW_BUCKETS * bucket_s * 2));   // Long gap
+        case 1:
+        case 2:
+            return 0;                                                                 // Burst
+        default:
+            return (uint32_t)(rand() % (int)(bucket_s + 1));
+    }
+}
+
+static void test_against_model(void)
+{
+    static const uint32_t window_lengths[] = { 60, 600, 3600, 86400, 59 };
+    static naive_window_t naive;
+    int mismatches = 0;
+
+    for (unsigned seed = 1; seed <= 40; seed++) {
+        srand(seed);
+        uint32_t window_s = window_lengths[seed % 5];
+        sensor_window_t window;
+        sensor_window_init(&window, window_s);
+        naive_init(&naive, window_s);
+
+        uint32_t t = (uint32_t)rand() % 100000;
+        uint32_t last_get = t;
+        int32_t level = rand() % 4000 - 2000;
+        for (int n = 0; n < NAIVE_MAX_SAMPLES / 2 && mismatches < 5; n++) {
+            t += random_step(naive.bucket_s);
+            level += rand() % 201 - 100;
+
+            // Readers run concurrently with the recording path, so a sample
+            // can be timestamped just before a query that advanced the window
+            uint32_t sample_t = t;
+            if (rand() % 8 == 0 && last_get > naive.bucket_s) {
+                sample_t = last_get - (uint32_t)(rand() % (int)naive.bucket_s) - 1;
+            }
+            sensor_window_add(&window, sample_t, level);
+            naive_add(&naive, sample_t, level);
+
+            if (rand() % 3 == 0) {
+                last_get = t + (uint32_t)(rand() % (int)(naive.bucket_s * 2));
+                mismatches += compare(&window, &naive, last_get);
+                t = last_get > t ? last_get : t;
+            }
+        }
+        mismatches += compare(&window, &naive, t);
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_late_sample_keeps_window);
+    RUN_TEST(test_jump_past_window);
+    RUN_TEST(test_against_model);
+    return TEST_EXIT();
+}
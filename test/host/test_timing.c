@@ -0,0 +1,79 @@
+/*
+ * Timing Utility Host Tests
+ *
+ * Exercises the timing API against timing_host.c: conversions at different
+ * cycle rates, elapsed time across a 32-bit cycle counter wrap, and delays
+ * driving the virtual clock.
+ */
+
+#include "test_harness.h"
+#include "timing.h"
+
+static void test_conversions(void)
+{
+    timing_mock_set_cycles_per_us(160);
+    CHECK_EQ(timing_cycles_per_us(), 160);
+    CHECK_EQ(timing_us_to_cycles(1000), 160000);
+    CHECK_EQ(timing_cycles_to_us(159), 0);
+    CHECK_EQ(timing_cycles_to_us(160), 1);
+    CHECK_EQ(timing_cycles_to_us(160 * 26 + 80), 26);
+
+    // A zero rate would divide by zero; the mock keeps the previous one
+    timing_mock_set_cycles_per_us(0);
+    CHECK_EQ(timing_cycles_per_us(), 160);
+
+    timing_mock_set_cycles_per_us(80);
+    CHECK_EQ(timing_us_to_cycles(70), 5600);
+    timing_mock_set_cycles_per_us(160);
+}
+
+static void test_elapsed(void)
+{
+    timing_init();
+    timing_cycles_t start = timing_cycles_now();
+    timing_mock_advance_us(80);
+    CHECK_EQ(timing_elapsed_us(start), 80);
+    timing_mock_advance_cycles(159);
+    CHECK_EQ(timing_elapsed_us(start), 80);
+    timing_mock_advance_cycles(1);
+    CHECK_EQ(timing_elapsed_us(start), 81);
+}
+
+static void test_elapsed_across_wrap(void)
+{
+    // Run the virtual counter up to just below 2^32 cycles
+    timing_cycles_t now = timing_cycles_now();
+    timing_mock_advance_cycles(UINT32_MAX - now - 1000);
+    timing_cycles_t start = timing_cycles_now();
+    CHECK(start > UINT32_MAX - 2000);
+
+    timing_mock_advance_us(50);
+    CHECK(timing_cycles_now() < start);
+    CHECK_EQ(timing_elapsed_us(start), 50);
+}
+
+static void test_delay_and_monotonic(void)
+{
+    int64_t before = timing_monotonic_us();
+    timing_cycles_t start = timing_cycles_now();
+    timing_delay_us(10);
+    CHECK_EQ(timing_elapsed_us(start), 10);
+    CHECK_EQ(timing_monotonic_us() - before, 10);
+    CHECK_EQ(timing_read_overhead_cycles(), 0);
+
+    // The monotonic clock keeps counting where the 32-bit counter wraps
+    before = timing_monotonic_us();
+    for (int i = 0; i < 40; i++) {
+        timing_mock_advance_us(1000000);
+    }
+    CHECK_EQ(timing_monotonic_us() - before, 40000000);
+}
+
+int main(void)
+{
+    RUN_TEST(test_conversions);
+    RUN_TEST(test_elapsed);
+    RUN_TEST(test_elapsed_across_wrap);
+    RUN_TEST(test_delay_and_monotonic);
+    return TEST_EXIT();
+}
@@ -0,0 +1,294 @@
+/*
+ * Time-Series Codec Host Tests
+ *
+ * Round trips through tsdb_encoder_add() and tsdb_decoder_next(): fixed
+ * edge cases for the zigzag, varint, delta-of-delta and XOR stages, and
+ * randomised series from smooth sensor data to full-range noise.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test_harness.h"
+#include "tsdb_codec.h"
+
+#define TEST_MAX_SAMPLES (TSDB_BLOCK_PAYLOAD_MAX + 1)
+
+typedef struct {
+    const uint8_t *data;
+    uint16_t len;
+    uint16_t pos;
+} byte_source_t;
+
+static bool read_byte(void *ctx, uint8_t *byte)
+{
+    byte_source_t *source = ctx;
+    if (source->pos >= source->len) {
+        return false;
+    }
+    *byte = source->data[source->pos++];
+    return true;
+}
+
+// Encode until the block is full or the series ends; returns samples stored
+static int encode(tsdb_encoder_t *encoder, const uint32_t *ts, const int32_t *values, int count)
+{
+    tsdb_encoder_reset(encoder);
+    int stored = 0;
+    while (stored < count && tsdb_encoder_add(encoder, ts[stored], values[stored])) {
+        stored++;
+    }
+    return stored;
+}
+
+// Decode the whole block and compare; returns mismatches
+static int decode_check(const tsdb_encoder_t *encoder, const uint32_t *ts, const int32_t *values, int count)
+{
+    tsdb_decoder_t decoder;
+    byte_source_t source = { .data = encoder->data, .len = encoder->len };
+    tsdb_decoder_init(&decoder, encoder->first_ts, encoder->count);
+
+    int mismatches = 0;
+    int n = 0;
+    uint32_t got_ts;
+    int32_t got_value;
+    while (tsdb_decoder_next(&decoder, read_byte, &source, &got_ts, &got_value)) {
+        if (n >= count || got_ts != ts[n] || got_value != values[n]) {
+            if (mismatches++ < 3) {
+                printf("  sample %d: got (%u, %d), expected (%u, %d)\n", n, got_ts, got_value,
+                       n < count ? ts[n] : 0, n < count ? values[n] : 0);
+            }
+        }
+        n++;
+    }
+    if (n != count || source.pos != encoder->len) {
+        printf("  decoded %d of %d samples, %u of %u bytes\n", n, count, source.pos, encoder->len);
+        mismatches++;
+    }
+    return mismatches;
+}
+
+static int round_trip(const uint32_t *ts, const int32_t *values, int count)
+{
+    tsdb_encoder_t encoder;
+    int stored = encode(&encoder, ts, values, count);
+    if (stored != count) {
+        printf("  only %d of %d samples fit\n", stored, count);
+        return 1;
+    }
+    return decode_check(&encoder, ts, values, count);
+}
+
+static void test_single_sample(void)
+{
+    static const int32_t values[] = { 0, 1, -1, 63, -64, 64, -65, INT32_MAX, INT32_MIN };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint32_t ts = 123456;
+        CHECK_EQ(round_trip(&ts, &values[i], 1), 0);
+    }
+
+    // Zigzag keeps small magnitudes of either sign in one byte
+    tsdb_encoder_t encoder;
+    tsdb_encoder_reset(&encoder);
+    CHECK(tsdb_encoder_add(&encoder, 0, -64));
+    CHECK_EQ(encoder.len, 1);
+    tsdb_encoder_reset(&encoder);
+    CHECK(tsdb_encoder_add(&encoder, 0, INT32_MIN));
+    CHECK_EQ(encoder.len, 5);
+}
+
+static void test_regular_series(void)
+{
+    // Once a minute, slowly changing: one byte of delta-of-delta, one of XOR
+    uint32_t ts[100];
+    int32_t values[100];
+    for (int i = 0; i < 100; i++) {
+        ts[i] = 1000 + (uint32_t)i * 60;
+        values[i] = 2150 + (i / 10);
+    }
+    tsdb_encoder_t encoder;
+    CHECK_EQ(encode(&encoder, ts, values, 100), 100);
+    CHECK_EQ(decode_check(&encoder, ts, values, 100), 0);
+    CHECK(encoder.len <= 2 + 99 * 2 + 1);
+}
+
+static void test_negative_values(void)
+{
+    uint32_t ts[8];
+    static const int32_t values[8] = { -4000, -3999, -4001, -1, 0, 1, -32768, 32767 };
+    for (int i = 0; i < 8; i++) {
+        ts[i] = (uint32_t)i * 60;
+    }
+    CHECK_EQ(round_trip(ts, values, 8), 0);
+}
+
+// XOR of the extremes sets all 32 bits: the widest value encoding
+static void test_xor_extremes(void)
+{
+    uint32_t ts[6] = { 0, 1, 2, 3, 4, 5 };
+    static const int32_t values[6] = { INT32_MIN, INT32_MAX, INT32_MIN, -1, 0, INT32_MAX };
+    tsdb_encoder_t encoder;
+    CHECK_EQ(encode(&encoder, ts, values, 6), 6);
+    CHECK_EQ(decode_check(&encoder, ts, values, 6), 0);
+    // 5 bytes first value, then 1 + 5 bytes per sample
+    CHECK_EQ(encoder.len, 5 + 5 * 6);
+}
+
+static void test_timestamp_jumps(void)
+{
+    // Deltas that push the delta-of-delta to both ends of the int32 range
+    // and beyond, including jumps of more than 2^31 seconds
+    uint32_t ts[] = { 0, 60, 0x7FFFFFFF, 0x80000000u, 0x80000000u, 0xFFFFFFF0u, 0xFFFFFFFFu,
+                      0xFFFFFFFFu };
+    int32_t values[sizeof(ts) / sizeof(ts[0])];
+    int count = (int)(sizeof(ts) / sizeof(ts[0]));
+    for (int i = 0; i < count; i++) {
+        values[i] = i * 1000 - 3000;
+    }
+    CHECK_EQ(round_trip(ts, values, count), 0);
+
+    // A jump of 2^31 after one of 2^31 - 1: the delta no longer fits int32
+    uint32_t wide[] = { 0, 0x7FFFFFFF, 0xFFFFFFFFu, 0xFFFFFFFFu };
+    CHECK_EQ(round_trip(wide, values, 4), 0);
+    uint32_t wide_first[] = { 5, 0x90000005u, 0x90000006u };
+    CHECK_EQ(round_trip(wide_first, values, 3), 0);
+
+    uint32_t sawtooth[40];
+    int32_t zeros[40] = { 0 };
+    for (int i = 0; i < 40; i++) {
+        sawtooth[i] = (i & 1) ? (uint32_t)i * 0x7FFFFFF : (uint32_t)i * 0x7FFFFFF + 0x7FFFFFFF;
+        if (i > 0 && sawtooth[i] < sawtooth[i - 1]) {
+            sawtooth[i] = sawtooth[i - 1];
+        }
+    }
+    CHECK_EQ(round_trip(sawtooth, zeros, 40), 0);
+}
+
+// A timestamp earlier than the previous one is stored as the previous one
+static void test_decreasing_timestamp(void)
+{
+    tsdb_encoder_t encoder;
+    tsdb_encoder_reset(&encoder);
+    CHECK(tsdb_encoder_add(&encoder, 500, 1));
+    CHECK(tsdb_encoder_add(&encoder, 400, 2));
+    CHECK(tsdb_encoder_add(&encoder, 560, 3));
+    CHECK_EQ(encoder.last_ts, 560);
+
+    uint32_t ts[] = { 500, 500, 560 };
+    int32_t values[] = { 1, 2, 3 };
+    CHECK_EQ(decode_check(&encoder, ts, values, 3), 0);
+}
+
+static void test_block_full(void)
+{
+    // Near worst-case samples fill the payload; the rejected sample leaves it intact
+    uint32_t ts[TEST_MAX_SAMPLES];
+    int32_t values[TEST_MAX_SAMPLES];
+    for (int i = 0; i < TEST_MAX_SAMPLES; i++) {
+        ts[i] = (uint32_t)(i / 2) * 0x2000000u;
+        values[i] = (i & 1) ? INT32_MIN : INT32_MAX;
+    }
+    tsdb_encoder_t encoder;
+    int stored = encode(&encoder, ts, values, TEST_MAX_SAMPLES);
+    CHECK(stored > 1 && stored < TEST_MAX_SAMPLES);
+    CHECK(encoder.len <= TSDB_BLOCK_PAYLOAD_MAX);
+    CHECK(encoder.len + TSDB_SAMPLE_BYTES_MAX > TSDB_BLOCK_PAYLOAD_MAX);
+    CHECK_EQ(encoder.count, stored);
+    CHECK_EQ(decode_check(&encoder, ts, values, stored), 0);
+}
+
+static void test_truncated_block(void)
+{
+    uint32_t ts[10];
+    int32_t values[10];
+    for (int i = 0; i < 10; i++) {
+        ts[i] = (uint32_t)i * 60;
+        values[i] = i * 300;
+    }
+    tsdb_encoder_t encoder;
+    CHECK_EQ(encode(&encoder, ts, values, 10), 10);
+
+    // The decoder stops at the end of the data instead of inventing samples
+    tsdb_decoder_t decoder;
+    byte_source_t source = { .data = encoder.data, .len = (uint16_t)(encoder.len - 1) };
+    tsdb_decoder_init(&decoder, encoder.first_ts, encoder.count);
+    uint32_t got_ts;
+    int32_t got_value;
+    int n = 0;
+    while (tsdb_decoder_next(&decoder, read_byte, &source, &got_ts, &got_value)) {
+        n++;
+    }
+    CHECK_EQ(n, 9);
+
+    // An overlong varint is rejected
+    static const uint8_t overlong[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+    source = (byte_source_t) { .data = overlong, .len = sizeof(overlong) };
+    tsdb_decoder_init(&decoder, 0, 1);
+    CHECK(!tsdb_decoder_next(&decoder, read_byte, &source, &got_ts, &got_value));
+}
+
+static uint32_t random_u32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static void test_random_series(void)
+{
+    int mismatches = 0;
+    long samples = 0;
+    long bytes = 0;
+    for (unsigned trial = 0; trial < 3000; trial++) {
+        srand(trial + 1);
+        uint32_t ts[TEST_MAX_SAMPLES];
+        int32_t values[TEST_MAX_SAMPLES];
+        uint32_t t = random_u32() / 2;
+        int32_t value = (int32_t)random_u32() / 65536;
+        for (int i = 0; i < TEST_MAX_SAMPLES; i++) {
+            uint32_t step;
+            switch (trial % 4) {
+                case 0:     // Sensor-like: jittered period, small steps
+                    t += 60 + (rand() % 7 == 0 ? (uint32_t)(rand() % 3) : 0);
+                    value += rand() % 5 - 2;
+                    break;
+                case 1:     // Irregular timestamps, random walk
+                    t += (uint32_t)(rand() % 100000);
+                    value += rand() % 2001 - 1000;
+                    break;
+                case 2:     // Full-range noise, saturating at the end of time
+                    step = random_u32() >> (rand() % 24 + 8);
+                    t = t + step < t ? UINT32_MAX : t + step;
+                    value = (int32_t)random_u32();
+                    break;
+                default:    // Repeated timestamps and values
+                    t += (uint32_t)(rand() % 2);
+                    break;
+            }
+            ts[i] = t;
+            values[i] = value;
+        }
+
+        tsdb_encoder_t encoder;
+        int stored = encode(&encoder, ts, values, TEST_MAX_SAMPLES);
+        mismatches += decode_check(&encoder, ts, values, stored);
+        if (trial % 4 == 0) {
+            samples += stored;
+            bytes += encoder.len;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    printf("  sensor-like series: %.2f bytes/sample\n", (double)bytes / (double)samples);
+    CHECK((double)bytes / (double)samples < 3.0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_single_sample);
+    RUN_TEST(test_regular_series);
+    RUN_TEST(test_negative_values);
+    RUN_TEST(test_xor_extremes);
+    RUN_TEST(test_timestamp_jumps);
+    RUN_TEST(test_decreasing_timestamp);
+    RUN_TEST(test_block_full);
+    RUN_TEST(test_truncated_block);
+    RUN_TEST(test_random_series);
+    return TEST_EXIT();
+}